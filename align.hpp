@@ -0,0 +1,139 @@
+#pragma once
+
+// Alignment of two sequences by the fingerprints of their items, shared
+// by the structural diffs (diff.hpp, s2/diff.hpp). Similar to patience
+// diff: after stripping the common prefix and suffix, items that are
+// unique in both sequences are used as anchors, the gaps between them
+// are paired positionally. Runs in O(n log n) but doesn't always find
+// the minimal alignment.
+
+#include "hash.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+enum class AlignOp {
+	pair, // a[ai] corresponds to b[bj], they may still differ
+	remove, // a[ai] has no counterpart
+	insert, // b[bj] has no counterpart, belongs before a[ai]
+};
+
+struct AlignStep {
+	AlignOp op;
+	std::size_t ai;
+	std::size_t bj;
+};
+
+namespace detail {
+
+// Returns the matched index pairs (anchors), increasing in both.
+// Only items with hashes unique in both ranges are considered,
+// the longest increasing subsequence of them is used.
+template<typename HA, typename HB>
+std::vector<std::pair<std::size_t, std::size_t>> anchors(
+		HA& a, std::size_t ab, std::size_t ae,
+		HB& b, std::size_t bb, std::size_t be) {
+	struct Count {
+		unsigned a {};
+		unsigned b {};
+		std::size_t ai {};
+	};
+
+	std::unordered_map<Fingerprint, Count> counts;
+	for(auto i = ab; i < ae; ++i) {
+		auto& c = counts[a(i)];
+		++c.a;
+		c.ai = i;
+	}
+
+	for(auto j = bb; j < be; ++j) {
+		auto it = counts.find(b(j));
+		if(it != counts.end()) {
+			++it->second.b;
+		}
+	}
+
+	std::vector<std::pair<std::size_t, std::size_t>> cands;
+	for(auto j = bb; j < be; ++j) {
+		auto it = counts.find(b(j));
+		if(it != counts.end() && it->second.a == 1u && it->second.b == 1u) {
+			cands.push_back({it->second.ai, j});
+		}
+	}
+
+	// longest increasing subsequence (in a) via patience sorting
+	std::vector<std::size_t> tails; // index into cands
+	std::vector<std::size_t> prev(cands.size());
+	for(auto k = 0u; k < cands.size(); ++k) {
+		auto it = std::lower_bound(tails.begin(), tails.end(), cands[k].first,
+			[&](std::size_t t, std::size_t ai) { return cands[t].first < ai; });
+		prev[k] = (it == tails.begin()) ? cands.size() : *(it - 1);
+		if(it == tails.end()) {
+			tails.push_back(k);
+		} else {
+			*it = k;
+		}
+	}
+
+	std::vector<std::pair<std::size_t, std::size_t>> ret(tails.size());
+	auto k = tails.empty() ? cands.size() : tails.back();
+	for(auto r = ret.size(); r-- > 0u;) {
+		ret[r] = cands[k];
+		k = prev[k];
+	}
+
+	return ret;
+}
+
+} // namespace detail
+
+// Aligns the 'na' items of a with the 'nb' items of b. hashA(i) and
+// hashB(j) return the fingerprints of the items. Items of the common
+// prefix and suffix aren't part of the returned steps, all others are,
+// ordered by their positions in a and b.
+template<typename HA, typename HB>
+std::vector<AlignStep> align(std::size_t na, HA&& hashA, std::size_t nb, HB&& hashB) {
+	std::vector<AlignStep> steps;
+
+	// common prefix and suffix
+	auto ab = std::size_t(0);
+	auto bb = std::size_t(0);
+	auto ae = na;
+	auto be = nb;
+	while(ab < ae && bb < be && hashA(ab) == hashB(bb)) {
+		++ab;
+		++bb;
+	}
+
+	while(ae > ab && be > bb && hashA(ae - 1) == hashB(be - 1)) {
+		--ae;
+		--be;
+	}
+
+	auto gap = [&](std::size_t ai, std::size_t ae, std::size_t bj, std::size_t be) {
+		for(; ai < ae && bj < be; ++ai, ++bj) {
+			steps.push_back({AlignOp::pair, ai, bj});
+		}
+
+		for(; ai < ae; ++ai) {
+			steps.push_back({AlignOp::remove, ai, 0u});
+		}
+
+		for(; bj < be; ++bj) {
+			steps.push_back({AlignOp::insert, ae, bj});
+		}
+	};
+
+	auto ai = ab;
+	auto bj = bb;
+	for(auto [aa, ba] : detail::anchors(hashA, ab, ae, hashB, bb, be)) {
+		gap(ai, aa, bj, ba);
+		ai = aa + 1;
+		bj = ba + 1;
+	}
+
+	gap(ai, ae, bj, be);
+	return steps;
+}
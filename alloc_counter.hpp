@@ -0,0 +1,50 @@
+#pragma once
+
+// Replaces the global operator new/delete to count the heap allocations
+// of each thread, see threadAllocations in stats.hpp.
+// Must only be included into a single translation unit of a program.
+
+#include "stats.hpp"
+#include <cstdlib>
+#include <new>
+
+void* operator new(std::size_t size) {
+	auto& allocs = threadAllocations();
+	++allocs.count;
+	allocs.bytes += size;
+
+	if(auto ptr = std::malloc(size ? size : 1u)) {
+		return ptr;
+	}
+
+	throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+	return ::operator new(size);
+}
+
+void operator delete(void* ptr) noexcept {
+	std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+	std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept {
+	std::free(ptr);
+}
+
+// Returns the heap allocations made by the calling thread in 'func'.
+template<typename F>
+AllocStats countAllocations(F&& func) {
+	auto start = threadAllocations();
+	func();
+	auto& end = threadAllocations();
+	return {end.count - start.count, end.bytes - start.bytes};
+}
@@ -0,0 +1,284 @@
+#pragma once
+
+// Minimal benchmark harness shared by the bench_*.cpp programs.
+// Measures wall-clock time and, on linux, hardware performance counters
+// (cycles, instructions, branch and cache misses) via perf_event_open.
+// Counters that can't be opened (e.g. no permissions, virtualized
+// environments without PMU) are reported as '-'.
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#ifdef __linux__
+	#include <linux/perf_event.h>
+	#include <sys/ioctl.h>
+	#include <sys/syscall.h>
+	#include <unistd.h>
+#endif
+
+inline std::string readFile(std::string_view filename) {
+	auto openmode = std::ios::ate;
+	std::ifstream ifs(std::string{filename}, openmode);
+	ifs.exceptions(std::ostream::failbit | std::ostream::badbit);
+
+	auto size = ifs.tellg();
+	ifs.seekg(0, std::ios::beg);
+
+	std::string buffer;
+	buffer.resize(size);
+	auto data = reinterpret_cast<char*>(buffer.data());
+	ifs.read(data, size);
+
+	return buffer;
+}
+
+// Generates a document of roughly 'size' bytes that is valid in all
+// grammar versions: a table of records with values and number arrays.
+// With 'comments', every line is accompanied by comments and blank lines.
+inline std::string generateInput(std::size_t size, bool comments = false) {
+	std::string ret;
+	ret.reserve(size + 256);
+	auto comment = [&](unsigned indent) {
+		if(comments) {
+			ret.append(indent, '\t');
+			ret += "# some comment explaining the following line\n\n";
+		}
+	};
+
+	for(auto i = 0u; ret.size() < size; ++i) {
+		auto id = std::to_string(i);
+		ret += "# record ";
+		ret += id;
+		ret += "\nrecord";
+		ret += id;
+		ret += ":\n";
+		comment(1u);
+		ret += "\tname: some name ";
+		ret += id;
+		ret += "\n";
+		comment(1u);
+		ret += "\tg: 0.8\n";
+		comment(1u);
+		ret += "\tscale_height: 1200\n\tscattering:\n\t\trgb:\n";
+		for(auto j = 0u; j < 3u; ++j) {
+			comment(3u);
+			ret += "\t\t\t5.e-5\n";
+		}
+
+		ret += "\tvalues:\n";
+		for(auto j = 0u; j < 16u; ++j) {
+			comment(2u);
+			ret += "\t\t1.";
+			ret += std::to_string(11776 + 37 * j);
+			ret += "\n";
+		}
+	}
+
+	return ret;
+}
+
+// Chains of tables nested 'depth' levels deep.
+inline std::string generateDeepInput(std::size_t size, unsigned depth = 48u) {
+	std::string ret;
+	ret.reserve(size + 256);
+	for(auto i = 0u; ret.size() < size; ++i) {
+		ret += "n";
+		ret += std::to_string(i);
+		ret += ":\n";
+		for(auto d = 1u; d < depth; ++d) {
+			ret.append(d, '\t');
+			ret += "level:\n";
+		}
+
+		ret.append(depth, '\t');
+		ret += "value: 42\n";
+	}
+
+	return ret;
+}
+
+// A single, long array of numbers.
+inline std::string generateArrayInput(std::size_t size) {
+	std::string ret;
+	ret.reserve(size + 256);
+	ret += "values:\n";
+	for(auto i = 0u; ret.size() < size; ++i) {
+		ret += "\t";
+		ret += std::to_string(i);
+		ret += ".0625\n";
+	}
+
+	return ret;
+}
+
+struct InputClass {
+	const char* name;
+	std::string input;
+};
+
+inline std::vector<InputClass> inputClasses(std::size_t size) {
+	return {
+		{"records", generateInput(size)},
+		{"deep nesting", generateDeepInput(size)},
+		{"long array", generateArrayInput(size)},
+		{"comment heavy", generateInput(size, true)},
+	};
+}
+
+// Input size in bytes for the benchmarks, from the first argument.
+inline std::size_t inputSize(int argc, const char** argv,
+		std::size_t fallback = 16 * 1024 * 1024) {
+	return argc > 1 ? std::strtoull(argv[1], nullptr, 10) : fallback;
+}
+
+struct PerfCounters {
+	enum Counter {
+		cycles,
+		instructions,
+		branches,
+		branchMisses,
+		cacheRefs,
+		cacheMisses,
+		count,
+	};
+
+	std::array<int, count> fds;
+	std::array<std::uint64_t, count> values {};
+
+	PerfCounters() {
+		fds.fill(-1);
+#ifdef __linux__
+		constexpr std::uint64_t configs[count] = {
+			PERF_COUNT_HW_CPU_CYCLES,
+			PERF_COUNT_HW_INSTRUCTIONS,
+			PERF_COUNT_HW_BRANCH_INSTRUCTIONS,
+			PERF_COUNT_HW_BRANCH_MISSES,
+			PERF_COUNT_HW_CACHE_REFERENCES,
+			PERF_COUNT_HW_CACHE_MISSES,
+		};
+
+		for(auto i = 0u; i < count; ++i) {
+			perf_event_attr attr {};
+			attr.size = sizeof(attr);
+			attr.type = PERF_TYPE_HARDWARE;
+			attr.config = configs[i];
+			attr.disabled = 1;
+			attr.exclude_kernel = 1;
+			attr.exclude_hv = 1;
+			fds[i] = int(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+		}
+#endif // __linux__
+	}
+
+	~PerfCounters() {
+#ifdef __linux__
+		for(auto fd : fds) {
+			if(fd >= 0) {
+				close(fd);
+			}
+		}
+#endif // __linux__
+	}
+
+	PerfCounters(const PerfCounters&) = delete;
+	PerfCounters& operator=(const PerfCounters&) = delete;
+
+	bool available(Counter c) const {
+		return fds[c] >= 0;
+	}
+
+	void start() {
+#ifdef __linux__
+		for(auto fd : fds) {
+			if(fd >= 0) {
+				ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+				ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+			}
+		}
+#endif // __linux__
+	}
+
+	void stop() {
+#ifdef __linux__
+		for(auto i = 0u; i < count; ++i) {
+			if(fds[i] >= 0) {
+				ioctl(fds[i], PERF_EVENT_IOC_DISABLE, 0);
+				if(read(fds[i], &values[i], sizeof(values[i])) != sizeof(values[i])) {
+					values[i] = 0u;
+				}
+			}
+		}
+#endif // __linux__
+	}
+};
+
+inline PerfCounters& perfCounters() {
+	static PerfCounters counters;
+	return counters;
+}
+
+inline void printHeader() {
+	std::printf("%-30s %-14s %9s %9s %8s %8s %8s %8s\n", "parser", "input",
+		"ms", "MB/s", "cyc/B", "ins/B", "br-miss", "$-miss");
+}
+
+// Runs 'func' 'runs' times, prints wall-clock time and counters of
+// the fastest run.
+template<typename F>
+void measure(const char* name, const char* input, std::size_t bytes,
+		unsigned runs, F&& func) {
+	using Clock = std::chrono::steady_clock;
+	using PC = PerfCounters;
+
+	auto& counters = perfCounters();
+	auto best = Clock::duration::max();
+	auto bestValues = counters.values;
+	for(auto i = 0u; i < runs; ++i) {
+		auto start = Clock::now();
+		counters.start();
+		func();
+		counters.stop();
+		auto dur = Clock::now() - start;
+		if(dur < best) {
+			best = dur;
+			bestValues = counters.values;
+		}
+	}
+
+	auto secs = std::chrono::duration<double>(best).count();
+	std::printf("%-30s %-14s %9.3f %9.1f", name, input, 1000.0 * secs,
+		bytes / (1024.0 * 1024.0 * secs));
+
+	auto perByte = [&](PC::Counter c) {
+		if(!counters.available(c)) {
+			std::printf(" %8s", "-");
+			return;
+		}
+
+		std::printf(" %8.2f", double(bestValues[c]) / bytes);
+	};
+
+	auto rate = [&](PC::Counter misses, PC::Counter total) {
+		if(!counters.available(misses) || !counters.available(total) ||
+				bestValues[total] == 0u) {
+			std::printf(" %8s", "-");
+			return;
+		}
+
+		std::printf(" %7.2f%%", 100.0 * bestValues[misses] / bestValues[total]);
+	};
+
+	perByte(PC::cycles);
+	perByte(PC::instructions);
+	rate(PC::branchMisses, PC::branches);
+	rate(PC::cacheMisses, PC::cacheRefs);
+	std::printf("\n");
+}
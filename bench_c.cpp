@@ -0,0 +1,41 @@
+#include "parse.h"
+#include "bench.hpp"
+
+// Usage: bench_c [input size]
+int main(int argc, const char** argv) {
+	auto runs = 5u;
+	printHeader();
+	for(auto& [name, input] : inputClasses(inputSize(argc, argv))) {
+		measure("parse_table_or_array", name, input.size(), runs, [&]{
+			struct parser parser {};
+			parser.input = input.c_str();
+			auto res = parse_table_or_array(&parser);
+			if(!res.success) {
+				std::printf("error %d at %d:%d\n", res.error.type,
+					res.error.location.line + 1, res.error.location.col + 1);
+				std::exit(EXIT_FAILURE);
+			}
+
+			destroy_value(&res.value.value);
+			std::free(parser.location.nest_tables);
+		});
+
+		// includes copying the input into the writable buffer
+		std::string buffer;
+		measure("parse_table_or_array (in situ)", name, input.size(), runs, [&]{
+			buffer = input;
+			struct parser parser {};
+			parser.input = buffer.c_str();
+			parser.in_situ = true;
+			auto res = parse_table_or_array(&parser);
+			if(!res.success) {
+				std::printf("error %d at %d:%d\n", res.error.type,
+					res.error.location.line + 1, res.error.location.col + 1);
+				std::exit(EXIT_FAILURE);
+			}
+
+			destroy_value(&res.value.value);
+			std::free(parser.location.nest_tables);
+		});
+	}
+}
@@ -0,0 +1,42 @@
+#include "parse_cb.h"
+#include "bench.hpp"
+
+// Usage: bench_cb [input size]
+// parse_file reads the inputs from a temporary file.
+void handler(struct parser* parser, const char*, const char*) {
+	++*static_cast<std::size_t*>(parser->user);
+}
+
+int main(int argc, const char** argv) {
+	auto runs = 5u;
+	auto tmpName = "bench_cb_input.qwe";
+	printHeader();
+	for(auto& [name, input] : inputClasses(inputSize(argc, argv))) {
+		auto check = [](const struct parse_result& res) {
+			if(res.error != error_type_none) {
+				std::printf("error %d at %d:%d\n", res.error,
+					res.parser.location.line + 1, res.parser.location.col + 1);
+				std::exit(EXIT_FAILURE);
+			}
+		};
+
+		std::size_t count = 0u;
+		measure("parse_string", name, input.size(), runs, [&]{
+			check(parse_string(input.c_str(), handler, &count));
+		});
+
+		auto file = std::fopen(tmpName, "wb");
+		std::fwrite(input.data(), 1, input.size(), file);
+		std::fclose(file);
+
+		measure("parse_file", name, input.size(), runs, [&]{
+			check(parse_file(tmpName, handler, &count));
+		});
+
+		measure("parse_file_read_ahead", name, input.size(), runs, [&]{
+			check(parse_file_read_ahead(tmpName, handler, &count));
+		});
+
+		std::remove(tmpName);
+	}
+}
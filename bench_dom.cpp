@@ -0,0 +1,39 @@
+#include "parse.hpp"
+#include "util.hpp"
+#include "bench.hpp"
+
+// Usage: bench_dom [input size]
+int main(int argc, const char** argv) {
+	auto runs = 5u;
+	printHeader();
+	for(auto& [name, input] : inputClasses(inputSize(argc, argv))) {
+		measure("parseTableOrArray", name, input.size(), runs, [&]{
+			Parser parser{input};
+			auto res = parseTableOrArray(parser);
+			if(auto err = std::get_if<Error>(&res)) {
+				std::printf("%s\n", print(*err).c_str());
+				std::exit(EXIT_FAILURE);
+			}
+		});
+
+		measure("parseTableOrArray (numeric)", name, input.size(), runs, [&]{
+			Parser parser{input};
+			parser.numericArrays = true;
+			auto res = parseTableOrArray(parser);
+			if(auto err = std::get_if<Error>(&res)) {
+				std::printf("%s\n", print(*err).c_str());
+				std::exit(EXIT_FAILURE);
+			}
+		});
+
+		measure("parseTableOrArray (pmr)", name, input.size(), runs, [&]{
+			std::pmr::monotonic_buffer_resource memory;
+			Parser parser{input};
+			auto res = parseTableOrArray(parser, &memory);
+			if(auto err = std::get_if<Error>(&res)) {
+				std::printf("%s\n", print(*err).c_str());
+				std::exit(EXIT_FAILURE);
+			}
+		});
+	}
+}
@@ -0,0 +1,121 @@
+#include "s2/pull.hpp"
+#include "s2/fingerprint.hpp"
+#include "s2/schema.hpp"
+#include "bench.hpp"
+
+// Compares the throughput of the pull reader with the callback parser
+// (counting, computing the fingerprint of the document and validating
+// it against a schema).
+// Usage: bench_pull [input size]
+struct Counter {
+	std::size_t tables {};
+	std::size_t entries {};
+
+	void enterTable(Parser&, std::string_view) {
+		++tables;
+	}
+
+	void exitTable(Parser&) {
+	}
+
+	void entry(Parser&, std::string_view) {
+		++entries;
+	}
+};
+
+void fail(const char* what, Location loc) {
+	std::printf("%s: error at %d:%d\n", what, loc.line + 1, loc.col + 1);
+	std::exit(EXIT_FAILURE);
+}
+
+// Matches all documents of bench.hpp's generators.
+constexpr auto schemaSource = std::string_view(R"(other:
+	other:
+		type: any
+	fields:
+		name:
+			type: string
+		g:
+			type: number
+			min: -1
+			max: 1
+		scale_height:
+			type: integer
+			min: 0
+		scattering:
+			fields:
+				rgb:
+					type: array
+					items: number
+					minItems: 3
+					maxItems: 3
+		values:
+			type: array
+			items: number
+			min: 0
+)");
+
+int main(int argc, const char** argv) {
+	auto runs = 5u;
+	auto schema = compileSchema(schemaSource);
+	assert(schema);
+	printHeader();
+	for(auto& [name, input] : inputClasses(inputSize(argc, argv))) {
+		Counter cbCounter;
+		measure("parseTable (parse2.hpp)", name, input.size(), runs, [&]{
+			cbCounter = {};
+			Parser parser{input};
+			Error error;
+			parseTable(cbCounter, parser, error);
+			if(error.type != ErrorType::none) {
+				fail("parse2.hpp", error.location);
+			}
+		});
+
+		measure("TableHasher (parse2.hpp)", name, input.size(), runs, [&]{
+			TableHasher hasher;
+			Parser parser{input};
+			Error error;
+			parseTable(hasher, parser, error);
+			if(error.type != ErrorType::none) {
+				fail("fingerprint", error.location);
+			}
+		});
+
+		measure("Validator (schema.hpp)", name, input.size(), runs, [&]{
+			std::vector<Violation> violations;
+			Parser parser{input};
+			Error error;
+			if(!validate(*schema, parser, error, violations)) {
+				fail("schema", violations.empty() ?
+					error.location : violations[0].location);
+			}
+		});
+
+		Counter pullCounter;
+		measure("Reader::next (pull.hpp)", name, input.size(), runs, [&]{
+			pullCounter = {};
+			Reader reader{{input}};
+			while(true) {
+				auto ev = reader.next();
+				if(ev.kind == EventKind::enterTable) {
+					++pullCounter.tables;
+				} else if(ev.kind == EventKind::entry) {
+					++pullCounter.entries;
+				} else if(ev.kind == EventKind::end) {
+					break;
+				} else if(ev.kind == EventKind::error) {
+					fail("pull.hpp", ev.location);
+				}
+			}
+		});
+
+		if(cbCounter.tables != pullCounter.tables ||
+				cbCounter.entries != pullCounter.entries) {
+			std::printf("Mismatch: tables %zu/%zu, entries %zu/%zu\n",
+				cbCounter.tables, pullCounter.tables,
+				cbCounter.entries, pullCounter.entries);
+			return EXIT_FAILURE;
+		}
+	}
+}
@@ -0,0 +1,32 @@
+#include "s2/parse.hpp"
+#include "bench.hpp"
+
+// Usage: bench_s2 [input size]
+int main(int argc, const char** argv) {
+	auto runs = 5u;
+	printHeader();
+	for(auto& [name, input] : inputClasses(inputSize(argc, argv))) {
+		measure("parseTable (s2/parse.hpp)", name, input.size(), runs, [&]{
+			Parser parser{input};
+			Error error;
+			auto table = parseTable(parser, error);
+			if(error.type != ErrorType::none || table.empty()) {
+				std::printf("error at %d:%d\n", error.location.line + 1,
+					error.location.col + 1);
+				std::exit(EXIT_FAILURE);
+			}
+		});
+
+		measure("parseTable (s2, pmr)", name, input.size(), runs, [&]{
+			std::pmr::monotonic_buffer_resource memory;
+			Parser parser{input};
+			Error error;
+			auto table = parseTable(parser, error, &memory);
+			if(error.type != ErrorType::none || table.empty()) {
+				std::printf("error at %d:%d\n", error.location.line + 1,
+					error.location.col + 1);
+				std::exit(EXIT_FAILURE);
+			}
+		});
+	}
+}
@@ -0,0 +1,123 @@
+#include "serialize.hpp"
+#include "bench.hpp"
+
+// Usage: bench_serialize [input size]
+// Only measures the input classes that can be bound to a struct.
+struct Scattering {
+	std::array<float, 3> rgb;
+};
+
+struct Record {
+	std::string name;
+	float g;
+	float scaleHeight;
+	Scattering scattering;
+	std::vector<float> values;
+};
+
+struct Values {
+	std::vector<float> values;
+};
+
+template<> struct Serializer<Record> : public PodSerializer<Record> {
+	template<typename RecordCV>
+	static constexpr auto map(RecordCV& r) {
+		return std::tuple{
+			MapEntry{"name", r.name, true},
+			MapEntry{"g", r.g, true},
+			MapEntry{"scale_height", r.scaleHeight, true},
+			MapEntry{"scattering.rgb", r.scattering.rgb, true},
+			MapEntry{"values", r.values, true},
+		};
+	}
+};
+
+template<> struct Serializer<Values> : public PodSerializer<Values> {
+	template<typename ValuesCV>
+	static constexpr auto map(ValuesCV& v) {
+		return std::tuple{
+			MapEntry{"values", v.values, true},
+		};
+	}
+};
+
+// Same records, bound as columns.
+struct RecordColumns {
+	std::vector<std::string> name;
+	std::vector<float> g;
+	std::vector<float> scaleHeight;
+	std::vector<std::array<float, 3>> rgb;
+	std::vector<std::vector<float>> values;
+};
+
+template<> struct Serializer<RecordColumns> : public ColumnSerializer<RecordColumns> {
+	template<typename ColumnsCV>
+	static constexpr auto map(ColumnsCV& c) {
+		return std::tuple{
+			ColumnEntry{"name", c.name, true},
+			ColumnEntry{"g", c.g, true},
+			ColumnEntry{"scale_height", c.scaleHeight, true},
+			ColumnEntry{"scattering.rgb", c.rgb, true},
+			ColumnEntry{"values", c.values, true},
+		};
+	}
+};
+
+template<typename T>
+void run(const char* name, const char* input, const std::string& data) {
+	measure(name, input, data.size(), 5u, [&]{
+		Parser parser{data};
+		auto res = parse<T>(parser);
+		if(auto err = std::get_if<ErrorType>(&res)) {
+			std::printf("error %d at %d:%d\n", int(*err),
+				parser.location.line + 1, parser.location.col + 1);
+			std::exit(EXIT_FAILURE);
+		}
+	});
+}
+
+// Array of records in array-nest syntax.
+std::string generateRecords(std::size_t size) {
+	auto records = generateInput(size);
+	std::string ret;
+	ret.reserve(records.size() + records.size() / 8);
+	std::string_view rest = records;
+	while(!rest.empty()) {
+		auto nl = rest.find('\n');
+		auto line = rest.substr(0, nl);
+		rest = (nl == rest.npos) ? std::string_view{} : rest.substr(nl + 1);
+		if(line.empty() || line[0] == '#') {
+			continue;
+		}
+
+		if(line[0] != '\t') { // 'recordN:'
+			ret += "-\n";
+			continue;
+		}
+
+		ret += line;
+		ret += '\n';
+	}
+
+	return ret;
+}
+
+int main(int argc, const char** argv) {
+	auto size = inputSize(argc, argv);
+	printHeader();
+	auto records = generateRecords(size);
+	run<std::vector<Record>>("PodSerializer::parse", "records", records);
+	run<RecordColumns>("ColumnSerializer::parse", "records", records);
+	run<std::unordered_map<std::string, Record>>("MapSerializer::parse",
+		"named records", generateInput(size));
+	auto array = generateArrayInput(size);
+	run<Values>("PodSerializer::parse", "long array", array);
+
+	// the same values as blob, see blob.hpp
+	Parser parser{array};
+	auto values = std::get<Values>(parse<Values>(parser));
+	Printer printer {};
+	printer.blobs = true;
+	print(printer, std::as_const(values));
+	run<Values>("PodSerializer::parse", "long array (blob)", printer.out);
+}
@@ -0,0 +1,326 @@
+#pragma once
+
+// Typed binary blobs: arrays of numbers stored as a single string
+//
+// @f32/3 AACAPwAAAEAAAEBA
+//
+// i.e. '@', the item type, '/', the number of items, a space and the
+// little-endian items encoded as (padded, standard alphabet) base64.
+// See spec.md. Used by serialize.hpp for vectors and arrays of numbers
+// and by parse.hpp/print.hpp for numeric arrays in the DOM.
+// Assumes a little-endian host.
+
+#ifdef __BYTE_ORDER__
+	static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__,
+		"blob.hpp assumes a little-endian host");
+#endif
+
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+enum class BlobType {
+	f32, f64,
+	i8, i16, i32, i64,
+	u8, u16, u32, u64,
+};
+
+struct Blob {
+	BlobType type;
+	std::size_t count; // number of items
+	std::string_view data; // base64
+};
+
+namespace detail {
+
+constexpr const char* blobTypeNames[] = {
+	"f32", "f64",
+	"i8", "i16", "i32", "i64",
+	"u8", "u16", "u32", "u64",
+};
+
+constexpr std::size_t blobTypeSizes[] = {
+	4u, 8u,
+	1u, 2u, 4u, 8u,
+	1u, 2u, 4u, 8u,
+};
+
+constexpr auto base64Chars =
+	"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+// Values of the base64 characters, 0xFF for all others.
+struct Base64Table {
+	std::uint8_t values[256] {};
+
+	constexpr Base64Table() {
+		for(auto& v : values) {
+			v = 0xFFu;
+		}
+
+		for(auto i = 0u; i < 64u; ++i) {
+			values[std::uint8_t(base64Chars[i])] = std::uint8_t(i);
+		}
+	}
+};
+
+inline constexpr Base64Table base64Table {};
+
+} // namespace detail
+
+inline std::size_t blobTypeSize(BlobType type) {
+	return detail::blobTypeSizes[unsigned(type)];
+}
+
+// The blob type of T, nullopt if there is none (e.g. bool).
+template<typename T>
+constexpr std::optional<BlobType> blobType() {
+	if constexpr(std::is_same_v<T, bool> || !std::is_arithmetic_v<T>) {
+		return std::nullopt;
+	} else if constexpr(std::is_floating_point_v<T>) {
+		if constexpr(std::is_same_v<T, float>) {
+			return BlobType::f32;
+		} else if constexpr(std::is_same_v<T, double>) {
+			return BlobType::f64;
+		} else {
+			return std::nullopt;
+		}
+	} else {
+		constexpr BlobType types[2][4] = {
+			{BlobType::u8, BlobType::u16, BlobType::u32, BlobType::u64},
+			{BlobType::i8, BlobType::i16, BlobType::i32, BlobType::i64},
+		};
+		constexpr auto log = sizeof(T) == 1u ? 0u : sizeof(T) == 2u ? 1u :
+			sizeof(T) == 4u ? 2u : 3u;
+		return types[std::is_signed_v<T>][log];
+	}
+}
+
+constexpr std::size_t base64Size(std::size_t bytes) {
+	return 4u * ((bytes + 2u) / 3u);
+}
+
+// Decodes exactly 'size' bytes from the padded base64 in 'in' (which must
+// have size base64Size(size)). Returns false on invalid characters.
+inline bool decodeBase64(std::string_view in, unsigned char* out, std::size_t size) {
+	if(in.size() != base64Size(size)) {
+		return false;
+	}
+
+	auto& table = detail::base64Table.values;
+	auto* src = reinterpret_cast<const unsigned char*>(in.data());
+
+	// Full groups without branches per character, invalid ones are
+	// only detected once at the end (their values have the high bit).
+	auto groups = size / 3u;
+	auto invalid = 0u;
+	for(auto g = std::size_t(0); g < groups; ++g) {
+		unsigned a = table[src[0]], b = table[src[1]];
+		unsigned c = table[src[2]], d = table[src[3]];
+		invalid |= a | b | c | d;
+		auto bits = (a << 18u) | (b << 12u) | (c << 6u) | d;
+		out[0] = (bits >> 16u) & 0xFFu;
+		out[1] = (bits >> 8u) & 0xFFu;
+		out[2] = bits & 0xFFu;
+		src += 4u;
+		out += 3u;
+	}
+
+	if(invalid & 0x80u) {
+		return false;
+	}
+
+	// last, padded group
+	auto rest = size % 3u;
+	if(rest == 0u) {
+		return true;
+	}
+
+	unsigned a = table[src[0]], b = table[src[1]];
+	unsigned c = rest == 2u ? table[src[2]] : 0u;
+	if((a | b | c) & 0x80u || src[3] != '=' || (rest == 1u && src[2] != '=')) {
+		return false;
+	}
+
+	auto bits = (a << 18u) | (b << 12u) | (c << 6u);
+	out[0] = (bits >> 16u) & 0xFFu;
+	if(rest == 2u) {
+		out[1] = (bits >> 8u) & 0xFFu;
+	}
+
+	return true;
+}
+
+// Appends the padded base64 encoding of the given bytes to 'out'.
+inline void encodeBase64(const unsigned char* in, std::size_t size, std::string& out) {
+	auto* chars = detail::base64Chars;
+	auto pos = out.size();
+	out.resize(pos + base64Size(size));
+	auto* dst = out.data() + pos;
+
+	auto i = std::size_t(0);
+	for(; i + 3u <= size; i += 3u) {
+		auto bits = (unsigned(in[i]) << 16u) | (unsigned(in[i + 1]) << 8u) | in[i + 2];
+		dst[0] = chars[(bits >> 18u) & 63u];
+		dst[1] = chars[(bits >> 12u) & 63u];
+		dst[2] = chars[(bits >> 6u) & 63u];
+		dst[3] = chars[bits & 63u];
+		dst += 4u;
+	}
+
+	if(i < size) {
+		auto bits = unsigned(in[i]) << 16u;
+		if(i + 1u < size) {
+			bits |= unsigned(in[i + 1]) << 8u;
+		}
+
+		dst[0] = chars[(bits >> 18u) & 63u];
+		dst[1] = chars[(bits >> 12u) & 63u];
+		dst[2] = i + 1u < size ? chars[(bits >> 6u) & 63u] : '=';
+		dst[3] = '=';
+	}
+}
+
+// Parses the header of a blob. Returns nullopt if 'str' isn't a blob,
+// doesn't check the characters of the data.
+inline std::optional<Blob> parseBlob(std::string_view str) {
+	if(str.empty() || str[0] != '@') {
+		return std::nullopt;
+	}
+
+	auto slash = str.find('/');
+	auto space = str.find(' ');
+	if(slash == str.npos || space == str.npos || space < slash) {
+		return std::nullopt;
+	}
+
+	auto name = str.substr(1, slash - 1);
+	auto type = std::optional<BlobType>{};
+	for(auto i = 0u; i < std::size(detail::blobTypeNames); ++i) {
+		if(name == detail::blobTypeNames[i]) {
+			type = BlobType(i);
+			break;
+		}
+	}
+
+	auto count = std::size_t(0);
+	auto first = str.data() + slash + 1;
+	auto last = str.data() + space;
+	auto res = std::from_chars(first, last, count);
+	if(!type || first == last || res.ec != std::errc{} || res.ptr != last) {
+		return std::nullopt;
+	}
+
+	// neither the size in bytes nor its base64 size may overflow
+	auto maxBytes = std::numeric_limits<std::size_t>::max() / 4u;
+	if(count > maxBytes / blobTypeSize(*type)) {
+		return std::nullopt;
+	}
+
+	auto data = str.substr(space + 1);
+	if(data.size() != base64Size(count * blobTypeSize(*type))) {
+		return std::nullopt;
+	}
+
+	return Blob{*type, count, data};
+}
+
+namespace detail {
+
+// Whether the item can be converted to T, i.e. is in its range.
+// Floating point items are truncated, like in the other conversions,
+// but NaN, infinity and out-of-range values (undefined behavior)
+// don't fit into integers.
+template<typename T, typename S>
+bool fitsBlobItem(S item) {
+	using TL = std::numeric_limits<T>;
+	if constexpr(std::is_floating_point_v<T>) {
+		if constexpr(sizeof(S) > sizeof(T) && std::is_floating_point_v<S>) {
+			return !std::isfinite(item) || std::fabs(item) <= S(TL::max());
+		} else {
+			return true;
+		}
+	} else if constexpr(std::is_floating_point_v<S>) {
+		// [min, max + 1), both powers of two (or zero), exact in S
+		constexpr auto lo = S(TL::min());
+		constexpr auto hi = S(TL::max() / 2 + 1) * S(2);
+		return item >= lo && item < hi;
+	} else if constexpr(std::is_signed_v<S> == std::is_signed_v<T>) {
+		return item >= TL::min() && item <= TL::max();
+	} else if constexpr(std::is_signed_v<S>) {
+		return item >= 0 && std::make_unsigned_t<S>(item) <= TL::max();
+	} else {
+		return item <= std::make_unsigned_t<T>(TL::max());
+	}
+}
+
+template<typename T, typename S>
+bool convertBlobItems(const unsigned char* src, std::size_t count, T* out) {
+	for(auto i = std::size_t(0); i < count; ++i) {
+		S item;
+		std::memcpy(&item, src + i * sizeof(S), sizeof(S));
+		if(!fitsBlobItem<T>(item)) {
+			return false;
+		}
+
+		out[i] = T(item);
+	}
+
+	return true;
+}
+
+} // namespace detail
+
+// Decodes the items of the blob into out[0, blob.count), converting
+// them to T if needed. Returns false if the data is invalid or an item
+// doesn't fit into T (see fitsBlobItem), e.g. a negative one into an
+// unsigned type. Items of type T are decoded in place, without
+// temporary buffer.
+template<typename T>
+bool decodeBlob(const Blob& blob, T* out) {
+	if(blobType<T>() == blob.type) {
+		return decodeBase64(blob.data, reinterpret_cast<unsigned char*>(out),
+			blob.count * sizeof(T));
+	}
+
+	std::vector<unsigned char> bytes(blob.count * blobTypeSize(blob.type));
+	if(!decodeBase64(blob.data, bytes.data(), bytes.size())) {
+		return false;
+	}
+
+	auto* src = bytes.data();
+	switch(blob.type) {
+		case BlobType::f32: return detail::convertBlobItems<T, float>(src, blob.count, out);
+		case BlobType::f64: return detail::convertBlobItems<T, double>(src, blob.count, out);
+		case BlobType::i8: return detail::convertBlobItems<T, std::int8_t>(src, blob.count, out);
+		case BlobType::i16: return detail::convertBlobItems<T, std::int16_t>(src, blob.count, out);
+		case BlobType::i32: return detail::convertBlobItems<T, std::int32_t>(src, blob.count, out);
+		case BlobType::i64: return detail::convertBlobItems<T, std::int64_t>(src, blob.count, out);
+		case BlobType::u8: return detail::convertBlobItems<T, std::uint8_t>(src, blob.count, out);
+		case BlobType::u16: return detail::convertBlobItems<T, std::uint16_t>(src, blob.count, out);
+		case BlobType::u32: return detail::convertBlobItems<T, std::uint32_t>(src, blob.count, out);
+		case BlobType::u64: return detail::convertBlobItems<T, std::uint64_t>(src, blob.count, out);
+	}
+
+	return false;
+}
+
+// Appends the blob of the given items to 'out'. T must have a blob type.
+template<typename T>
+void printBlob(std::string& out, const T* items, std::size_t count) {
+	constexpr auto type = blobType<T>();
+	static_assert(type.has_value(), "No blob type for T");
+
+	out += '@';
+	out += detail::blobTypeNames[unsigned(*type)];
+	out += '/';
+	out += std::to_string(count);
+	out += ' ';
+	encodeBase64(reinterpret_cast<const unsigned char*>(items), count * sizeof(T), out);
+}
@@ -26,6 +26,104 @@ inline std::pair<std::string_view, std::string_view> splitIf(
 	return (pos == src.npos) ? std::pair{src, std::string_view{}} : split(src, pos);
 }
 
+enum class PathMatch {
+	none, // path can't match any projected path
+	ancestor, // path is a prefix of a projected path
+	inside, // path is equal to or inside a projected path
+};
+
+// Matches the path given by the 'depth' segments in 'nest', followed
+// by '*last' if it's not null, against the dotted, projected path
+// 'proj'. An empty projected path matches everything.
+inline PathMatch matchPath(std::string_view proj, const std::string_view* nest,
+		std::size_t depth, const std::string_view* last = nullptr) {
+	if(proj.empty()) {
+		return PathMatch::inside;
+	}
+
+	auto pos = std::size_t(0);
+	auto count = depth + (last ? 1u : 0u);
+	for(auto i = std::size_t(0); i < count; ++i) {
+		if(pos > proj.size()) {
+			return PathMatch::inside;
+		}
+
+		auto seg = i < depth ? nest[i] : *last;
+		auto end = pos + seg.size();
+		if(proj.substr(pos, seg.size()) != seg ||
+				(end < proj.size() && proj[end] != '.')) {
+			return PathMatch::none;
+		}
+
+		pos = end + 1;
+	}
+
+	return pos > proj.size() ? PathMatch::inside : PathMatch::ancestor;
+}
+
+// Best match of the path against all 'count' projected paths, see
+// matchPath. Everything is inside if there are none.
+inline PathMatch matchPaths(const std::string_view* paths, std::size_t count,
+		const std::string_view* nest, std::size_t depth,
+		const std::string_view* last = nullptr) {
+	if(count == 0u) {
+		return PathMatch::inside;
+	}
+
+	auto res = PathMatch::none;
+	for(auto i = std::size_t(0); i < count; ++i) {
+		auto m = matchPath(paths[i], nest, depth, last);
+		if(m == PathMatch::inside) {
+			return m;
+		}
+
+		if(m == PathMatch::ancestor) {
+			res = m;
+		}
+	}
+
+	return res;
+}
+
+// Skips all lines of the value at indentation 'indent' at the start
+// of 'in', i.e. until a line with lower indentation is found.
+// Only checks the indentation of each line, jumps to the next line
+// via memchr (string_view::find). Comments and empty lines are
+// skipped as well. Updates 'line' and 'col'. Returns whether any of
+// the skipped lines has content, an empty value might be an error.
+inline bool skipIndented(std::string_view& in, std::size_t indent,
+		unsigned& line, unsigned& col) {
+	auto content = false;
+	while(!in.empty()) {
+		auto i = std::size_t(0);
+		while(i < indent && i < in.size() && in[i] == '\t') {
+			++i;
+		}
+
+		if(i < indent && i < in.size() && in[i] != '\n' && in[i] != '#') {
+			break;
+		}
+
+		if(!content) {
+			auto first = in.find_first_not_of('\t', i);
+			content = first != in.npos && in[first] != '\n' && in[first] != '#';
+		}
+
+		auto nl = in.find('\n', i);
+		if(nl == in.npos) {
+			col = in.size();
+			in = {};
+			return content;
+		}
+
+		++line;
+		in = in.substr(nl + 1);
+	}
+
+	col = 0u;
+	return content;
+}
+
 template<std::size_t... I, typename F, typename Tuple>
 bool for_each_or(std::index_sequence<I...>, Tuple& tup, F&& func) {
 	return (func(std::get<I>(tup)) || ...);
@@ -48,6 +146,19 @@ struct MapEntry {
 template<typename T> MapEntry(std::string_view, T&) -> MapEntry<T>;
 template<typename T> MapEntry(std::string_view, T&, bool) -> MapEntry<T>;
 
+// Column of a struct-of-arrays binding: every record of an array
+// appends its field value to the container 'val', e.g. a std::vector.
+template<typename C>
+struct ColumnEntry {
+	std::string_view name;
+	C& val;
+	bool required {};
+	bool done {}; // found in the current record
+};
+
+template<typename C> ColumnEntry(std::string_view, C&) -> ColumnEntry<C>;
+template<typename C> ColumnEntry(std::string_view, C&, bool) -> ColumnEntry<C>;
+
 template<typename T, typename B>
 auto templatize(B&& val) {
 	return val;
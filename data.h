@@ -19,39 +19,58 @@ enum value_type {
 
 struct value {
 	enum value_type type;
+	unsigned flags; // enum value_flags, what is not owned by this value
 	union {
-		const char* string; // owned
+		const char* string; // owned, see flags
 		struct vector vector;
 		struct table table;
 	};
 };
 
 struct table_entry {
-	const char* name; // owned
+	const char* name; // owned, see the flags of the table
 	struct value value; // owned
 };
 
 #include <stdlib.h>
 
-void destroy_value(const value* val) {
+enum value_flags {
+	value_flags_none = 0,
+	// table entry names are not owned, e.g. because they are interned
+	value_flags_borrowed_names = 1,
+	// string values are not owned, e.g. because they point into the input
+	value_flags_borrowed_strings = 2,
+};
+
+// Like destroy_value, with additional 'flags' for the whole tree.
+void destroy_value_flags(const struct value* val, unsigned flags) {
+	flags |= val->flags;
 	switch(val->type) {
 		case value_type_string:
-			free((void*) val->string);
+			if(!(flags & value_flags_borrowed_strings)) {
+				free((void*) val->string);
+			}
 			break;
 		case value_type_vector:
 			for(size_t i = 0u; i < val->vector.n_values; ++i) {
-				destroy_value(&val->vector.values[i]);
+				destroy_value_flags(&val->vector.values[i], flags);
 			}
 
 			free(val->vector.values);
 			break;
 		case value_type_table:
 			for(size_t i = 0u; i < val->table.n_entries; ++i) {
-				destroy_value(&val->table.entries[i].value);
-				free((void*) val->table.entries[i].name);
+				destroy_value_flags(&val->table.entries[i].value, flags);
+				if(!(flags & value_flags_borrowed_names)) {
+					free((void*) val->table.entries[i].name);
+				}
 			}
 
 			free(val->vector.values);
 			break;
 	}
 }
+
+void destroy_value(const struct value* val) {
+	destroy_value_flags(val, value_flags_none);
+}
@@ -1,10 +1,13 @@
 #pragma once
 
+#include <charconv>
+#include <cstdint>
 #include <string_view>
 #include <string>
 #include <utility>
 #include <vector>
 #include <memory>
+#include <memory_resource>
 #include <variant>
 #include <unordered_map>
 
@@ -15,6 +18,52 @@ struct Value;
 using Table = std::unordered_map<std::string, std::unique_ptr<Value>>;
 using Vector = std::vector<std::unique_ptr<Value>>;
 
+// Contiguous storage of arrays whose items are all numbers (all integers
+// for Integers), see Parser::numericArrays in parse.hpp. Their original
+// text is not kept.
+using Integers = std::vector<std::int64_t>;
+using Numbers = std::vector<double>;
+
+struct Value {
+	std::variant<std::string, Vector, Table, Integers, Numbers> value;
+};
+
+// Shortest text that parses back to the same double.
+inline std::string numberString(double number) {
+	char buf[32];
+	auto res = std::to_chars(buf, buf + sizeof(buf), number);
+	return std::string(buf, res.ptr);
+}
+
+// Variant of the representation above that allocates all memory from a
+// std::pmr::memory_resource, e.g. a monotonic_buffer_resource so that a
+// whole document can be released at once.
+namespace pmr {
+
+struct Value;
+
+// Destroys values created via makeValue.
+struct ValueDeleter {
+	std::pmr::memory_resource* memory {};
+	void operator()(Value* value) const;
+};
+
+using ValuePtr = std::unique_ptr<Value, ValueDeleter>;
+using Table = std::pmr::unordered_map<std::pmr::string, ValuePtr>;
+using Vector = std::pmr::vector<ValuePtr>;
+
 struct Value {
-	std::variant<std::string, Vector, Table> value;
+	std::variant<std::pmr::string, Vector, Table> value;
 };
+
+inline void ValueDeleter::operator()(Value* value) const {
+	value->~Value();
+	memory->deallocate(value, sizeof(Value), alignof(Value));
+}
+
+inline ValuePtr makeValue(std::pmr::memory_resource* memory, Value&& value) {
+	auto ptr = memory->allocate(sizeof(Value), alignof(Value));
+	return {new(ptr) Value{std::move(value)}, {memory}};
+}
+
+} // namespace pmr
@@ -0,0 +1,403 @@
+#pragma once
+
+// Structural diff and patch for the Value model of data.hpp.
+// A patch is a list of edits (insert, remove, replace) that transforms
+// one value into another. Identical subtrees are detected via their
+// fingerprints (see fingerprint.hpp) and skipped. Tables are compared
+// by key, vectors are aligned via align.hpp.
+// See s2/diff.hpp for the same for s2 tables.
+//
+// Paths are dotted table keys and vector indices from the root, e.g.
+// "mie.scattering.2"; the empty path is the root itself. Dots and
+// backslashes in keys are escaped with a backslash. Indices refer to
+// the document as it is when the edit is applied, i.e. after all
+// previous edits of the patch.
+// Patches can be converted to a Value (and printed/parsed as such).
+
+#include "align.hpp"
+#include "common.hpp"
+#include "data.hpp"
+#include "fingerprint.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+enum class EditKind {
+	insert, // insert 'value' at 'path'
+	remove, // remove the value at 'path'
+	replace, // replace the value at 'path' with 'value'
+};
+
+struct Edit {
+	EditKind kind;
+	std::string path;
+	std::unique_ptr<Value> value {}; // for insert, replace
+};
+
+using Patch = std::vector<Edit>;
+
+// Deep copy of a value.
+inline std::unique_ptr<Value> clone(const Value& value) {
+	return std::visit(Visitor{
+		[](const std::string& str) {
+			return std::make_unique<Value>(Value{str});
+		}, [](const Vector& vec) {
+			Vector ret;
+			ret.reserve(vec.size());
+			for(auto& val : vec) {
+				ret.push_back(clone(*val));
+			}
+			return std::make_unique<Value>(Value{std::move(ret)});
+		}, [](const Table& table) {
+			Table ret;
+			ret.reserve(table.size());
+			for(auto& [name, val] : table) {
+				ret.emplace(name, clone(*val));
+			}
+			return std::make_unique<Value>(Value{std::move(ret)});
+		}, [](const Integers& ints) {
+			return std::make_unique<Value>(Value{ints});
+		}, [](const Numbers& nums) {
+			return std::make_unique<Value>(Value{nums});
+		},
+	}, value.value);
+}
+
+namespace detail {
+
+inline std::string childPath(const std::string& path, std::string_view key) {
+	std::string ret = path;
+	if(!ret.empty()) {
+		ret += '.';
+	}
+
+	for(auto c : key) {
+		if(c == '.' || c == '\\') {
+			ret += '\\';
+		}
+
+		ret += c;
+	}
+
+	return ret;
+}
+
+inline std::string childPath(const std::string& path, std::size_t i) {
+	return childPath(path, std::to_string(i));
+}
+
+inline void diff(const Value& a, FingerprintCache& ha,
+		const Value& b, FingerprintCache& hb,
+		const std::string& path, Patch& out);
+
+inline void diffTables(const Table& a, FingerprintCache& ha,
+		const Table& b, FingerprintCache& hb,
+		const std::string& path, Patch& out) {
+	// sorted, so that the patch is deterministic
+	std::vector<std::string_view> removed;
+	std::vector<std::string_view> common;
+	for(auto& [name, val] : a) {
+		(b.count(name) ? common : removed).push_back(name);
+	}
+
+	std::vector<std::string_view> inserted;
+	for(auto& [name, val] : b) {
+		if(!a.count(name)) {
+			inserted.push_back(name);
+		}
+	}
+
+	std::sort(removed.begin(), removed.end());
+	std::sort(common.begin(), common.end());
+	std::sort(inserted.begin(), inserted.end());
+
+	for(auto name : removed) {
+		out.push_back({EditKind::remove, childPath(path, name)});
+	}
+
+	for(auto name : common) {
+		auto key = std::string(name);
+		diff(*a.at(key), ha, *b.at(key), hb, childPath(path, name), out);
+	}
+
+	for(auto name : inserted) {
+		out.push_back({EditKind::insert, childPath(path, name),
+			clone(*b.at(std::string(name)))});
+	}
+}
+
+inline void diffVectors(const Vector& a, FingerprintCache& ha,
+		const Vector& b, FingerprintCache& hb,
+		const std::string& path, Patch& out) {
+	std::vector<Fingerprint> hashesA(a.size());
+	std::vector<Fingerprint> hashesB(b.size());
+	for(auto i = 0u; i < a.size(); ++i) {
+		hashesA[i] = fingerprint(*a[i], ha);
+	}
+
+	for(auto j = 0u; j < b.size(); ++j) {
+		hashesB[j] = fingerprint(*b[j], hb);
+	}
+
+	// edits are emitted from back to front, so that the indices of
+	// the earlier items stay valid.
+	auto steps = align(a.size(), [&](std::size_t i) { return hashesA[i]; },
+		b.size(), [&](std::size_t j) { return hashesB[j]; });
+
+	for(auto s = steps.size(); s-- > 0u;) {
+		auto& step = steps[s];
+		auto p = childPath(path, step.ai);
+		switch(step.op) {
+			case AlignOp::pair:
+				diff(*a[step.ai], ha, *b[step.bj], hb, p, out);
+				break;
+			case AlignOp::remove:
+				out.push_back({EditKind::remove, std::move(p)});
+				break;
+			case AlignOp::insert:
+				out.push_back({EditKind::insert, std::move(p), clone(*b[step.bj])});
+				break;
+		}
+	}
+}
+
+inline void diff(const Value& a, FingerprintCache& ha,
+		const Value& b, FingerprintCache& hb,
+		const std::string& path, Patch& out) {
+	if(fingerprint(a, ha) == fingerprint(b, hb)) {
+		return;
+	}
+
+	auto* ta = std::get_if<Table>(&a.value);
+	auto* tb = std::get_if<Table>(&b.value);
+	if(ta && tb) {
+		diffTables(*ta, ha, *tb, hb, path, out);
+		return;
+	}
+
+	auto* va = std::get_if<Vector>(&a.value);
+	auto* vb = std::get_if<Vector>(&b.value);
+	if(va && vb) {
+		diffVectors(*va, ha, *vb, hb, path, out);
+		return;
+	}
+
+	out.push_back({EditKind::replace, path, clone(b)});
+}
+
+// Splits off the first segment of 'path', resolving escapes.
+inline std::string nextSegment(std::string_view& path) {
+	std::string ret;
+	auto i = std::size_t(0);
+	for(; i < path.size() && path[i] != '.'; ++i) {
+		if(path[i] == '\\' && i + 1 < path.size()) {
+			++i;
+		}
+
+		ret += path[i];
+	}
+
+	path = (i < path.size()) ? path.substr(i + 1) : std::string_view{};
+	return ret;
+}
+
+inline std::optional<std::size_t> parseIndex(const std::string& seg) {
+	char* end {};
+	auto i = std::strtoull(seg.c_str(), &end, 10);
+	if(seg.empty() || end != seg.c_str() + seg.size()) {
+		return std::nullopt;
+	}
+
+	return i;
+}
+
+} // namespace detail
+
+// Returns the edits transforming 'a' into 'b'.
+inline Patch diff(const Value& a, const Value& b) {
+	Patch ret;
+	FingerprintCache ha, hb;
+	detail::diff(a, ha, b, hb, {}, ret);
+	return ret;
+}
+
+// Applies the patch in place. Returns false if an edit has an invalid
+// path. The edits before it were applied then.
+inline bool applyPatch(Value& doc, const Patch& patch) {
+	for(auto& edit : patch) {
+		if(edit.kind != EditKind::remove && !edit.value) {
+			return false;
+		}
+
+		if(edit.path.empty()) {
+			if(edit.kind != EditKind::replace) {
+				return false;
+			}
+
+			doc = std::move(*clone(*edit.value));
+			continue;
+		}
+
+		auto* value = &doc;
+		std::string_view path = edit.path;
+		while(true) {
+			auto seg = detail::nextSegment(path);
+			auto last = path.empty();
+			if(auto* table = std::get_if<Table>(&value->value)) {
+				auto it = table->find(seg);
+				if(!last) {
+					if(it == table->end()) {
+						return false;
+					}
+
+					value = it->second.get();
+					continue;
+				}
+
+				auto exists = (it != table->end());
+				if(exists == (edit.kind == EditKind::insert)) {
+					return false;
+				}
+
+				switch(edit.kind) {
+					case EditKind::insert:
+						table->emplace(std::move(seg), clone(*edit.value));
+						break;
+					case EditKind::remove:
+						table->erase(it);
+						break;
+					case EditKind::replace:
+						it->second = clone(*edit.value);
+						break;
+				}
+			} else if(auto* vec = std::get_if<Vector>(&value->value)) {
+				auto i = detail::parseIndex(seg);
+				if(!last) {
+					if(!i || *i >= vec->size()) {
+						return false;
+					}
+
+					value = (*vec)[*i].get();
+					continue;
+				}
+
+				auto limit = vec->size() + (edit.kind == EditKind::insert);
+				if(!i || *i >= limit) {
+					return false;
+				}
+
+				auto it = vec->begin() + *i;
+				switch(edit.kind) {
+					case EditKind::insert:
+						vec->insert(it, clone(*edit.value));
+						break;
+					case EditKind::remove:
+						vec->erase(it);
+						break;
+					case EditKind::replace:
+						*it = clone(*edit.value);
+						break;
+				}
+			} else {
+				return false;
+			}
+
+			break;
+		}
+	}
+
+	return true;
+}
+
+// Patch as value, e.g. for printing. A vector of tables:
+// -
+// 	op: insert
+// 	path: mie.scattering.2
+// 	value: 0.5
+// The path is omitted for the root.
+inline Value toValue(const Patch& patch) {
+	Vector ret;
+	ret.reserve(patch.size());
+	for(auto& edit : patch) {
+		Table table;
+		switch(edit.kind) {
+			case EditKind::insert: table["op"] = clone(Value{"insert"}); break;
+			case EditKind::remove: table["op"] = clone(Value{"remove"}); break;
+			case EditKind::replace: table["op"] = clone(Value{"replace"}); break;
+		}
+
+		if(!edit.path.empty()) {
+			table["path"] = clone(Value{edit.path});
+		}
+
+		if(edit.value) {
+			table["value"] = clone(*edit.value);
+		}
+
+		ret.push_back(std::make_unique<Value>(Value{std::move(table)}));
+	}
+
+	return {std::move(ret)};
+}
+
+// Inverse of toValue. Returns nullopt if 'value' is not a valid patch.
+inline std::optional<Patch> fromValue(const Value& value) {
+	auto* vec = std::get_if<Vector>(&value.value);
+	if(!vec) {
+		return std::nullopt;
+	}
+
+	Patch ret;
+	for(auto& item : *vec) {
+		auto* table = std::get_if<Table>(&item->value);
+		if(!table) {
+			return std::nullopt;
+		}
+
+		auto string = [&](const char* name) -> const std::string* {
+			auto it = table->find(name);
+			return it == table->end() ? nullptr :
+				std::get_if<std::string>(&it->second->value);
+		};
+
+		Edit edit;
+		auto* op = string("op");
+		if(!op) {
+			return std::nullopt;
+		} else if(*op == "insert") {
+			edit.kind = EditKind::insert;
+		} else if(*op == "remove") {
+			edit.kind = EditKind::remove;
+		} else if(*op == "replace") {
+			edit.kind = EditKind::replace;
+		} else {
+			return std::nullopt;
+		}
+
+		auto* path = string("path");
+		if(path) {
+			edit.path = *path;
+		} else if(table->count("path")) {
+			return std::nullopt;
+		}
+
+		auto it = table->find("value");
+		auto hasValue = (it != table->end());
+		if(hasValue != (edit.kind != EditKind::remove)) {
+			return std::nullopt;
+		}
+
+		if(hasValue) {
+			edit.value = clone(*it->second);
+		}
+
+		ret.push_back(std::move(edit));
+	}
+
+	return ret;
+}
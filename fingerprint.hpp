@@ -0,0 +1,91 @@
+#pragma once
+
+// Fingerprints (128-bit content hashes, see hash.hpp) of data.hpp values.
+// Vectors are hashed order-sensitive, tables independent of their
+// (unspecified) iteration order. Equal values have equal fingerprints,
+// different ones (up to collisions) different fingerprints.
+
+#include "common.hpp"
+#include "data.hpp"
+#include "hash.hpp"
+#include <cstring>
+#include <unordered_map>
+
+namespace detail {
+
+// Seeds per kind, so that e.g. an empty vector and an empty table differ.
+constexpr auto vectorFingerprintSeed = Fingerprint{0x8f1bbcdc5a827999u, 0x6ed9eba1ca62c1d6u};
+constexpr auto tableFingerprintSeed = Fingerprint{0xca62c1d68f1bbcdcu, 0x5a8279996ed9eba1u};
+constexpr auto integersFingerprintSeed = Fingerprint{0x6ed9eba1ca62c1d6u, 0x8f1bbcdc5a827999u};
+constexpr auto numbersFingerprintSeed = Fingerprint{0x5a8279996ed9eba1u, 0xca62c1d68f1bbcdcu};
+
+// Integers and Numbers, by value.
+template<typename C>
+Fingerprint numbersFingerprint(Fingerprint seed, const C& numbers) {
+	auto ret = seed;
+	for(auto number : numbers) {
+		std::uint64_t bits;
+		std::memcpy(&bits, &number, sizeof(bits));
+		ret = hashCombine(ret, bits);
+	}
+
+	return hashCombine(ret, numbers.size());
+}
+
+template<typename F>
+Fingerprint fingerprint(const Value& value, F&& child) {
+	return std::visit(Visitor{
+		[](const std::string& str) {
+			return hashString(str);
+		}, [&](const Vector& vec) {
+			auto ret = vectorFingerprintSeed;
+			for(auto& val : vec) {
+				ret = hashCombine(ret, child(*val));
+			}
+			return hashCombine(ret, vec.size());
+		}, [&](const Table& table) {
+			// the sum of the entries is independent of the order
+			auto sum = Fingerprint{};
+			for(auto& [name, val] : table) {
+				auto entry = hashCombine(hashString(name), child(*val));
+				sum.lo += entry.lo;
+				sum.hi += entry.hi;
+			}
+			return hashCombine(hashCombine(tableFingerprintSeed, sum), table.size());
+		}, [](const Integers& ints) {
+			return numbersFingerprint(integersFingerprintSeed, ints);
+		}, [](const Numbers& nums) {
+			return numbersFingerprint(numbersFingerprintSeed, nums);
+		},
+	}, value.value);
+}
+
+} // namespace detail
+
+inline Fingerprint fingerprint(const Value& value) {
+	return detail::fingerprint(value, [](const Value& child) {
+		return fingerprint(child);
+	});
+}
+
+// Fingerprints of values, by address. Filled lazily by the overload below.
+// Entries of values that are modified (or destroyed) must be erased,
+// e.g. by clearing the whole cache.
+using FingerprintCache = std::unordered_map<const Value*, Fingerprint>;
+
+// Like above, but returns the cached fingerprint if there is one and
+// caches the fingerprints of the value and all its children otherwise.
+// Comparing two cached subtrees is O(1) then.
+inline Fingerprint fingerprint(const Value& value, FingerprintCache& cache) {
+	auto it = cache.find(&value);
+	if(it != cache.end()) {
+		return it->second;
+	}
+
+	auto ret = detail::fingerprint(value, [&](const Value& child) {
+		return fingerprint(child, cache);
+	});
+
+	cache.emplace(&value, ret);
+	return ret;
+}
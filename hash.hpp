@@ -0,0 +1,80 @@
+#pragma once
+
+// 128-bit content hashes (fingerprints) used for subtree equality
+// checks, change detection and cache keys, see fingerprint.hpp and
+// s2/fingerprint.hpp. Fast and well distributed but not cryptographic:
+// don't use them where collisions could be provoked deliberately.
+// The lower half ('lo') can be used as a 64-bit hash.
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string_view>
+
+struct Fingerprint {
+	std::uint64_t lo {};
+	std::uint64_t hi {};
+
+	bool operator==(const Fingerprint& other) const {
+		return lo == other.lo && hi == other.hi;
+	}
+
+	bool operator!=(const Fingerprint& other) const {
+		return !(*this == other);
+	}
+};
+
+template<>
+struct std::hash<Fingerprint> {
+	std::size_t operator()(const Fingerprint& fp) const {
+		return std::size_t(fp.lo);
+	}
+};
+
+// splitmix64 finalizer
+inline std::uint64_t hashMix(std::uint64_t x) {
+	x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9u;
+	x = (x ^ (x >> 27)) * 0x94d049bb133111ebu;
+	return x ^ (x >> 31);
+}
+
+inline Fingerprint hashString(std::string_view str) {
+	constexpr auto k1 = std::uint64_t(0x9e3779b97f4a7c15u);
+	constexpr auto k2 = std::uint64_t(0xc2b2ae3d27d4eb4fu);
+	auto lo = k1 ^ str.size();
+	auto hi = k2 ^ (str.size() * k1);
+	auto add = [&](std::uint64_t w) {
+		lo = (lo ^ w) * k2;
+		lo = (lo << 31) | (lo >> 33);
+		hi = (hi ^ w) * k1;
+		hi = (hi << 29) | (hi >> 35);
+	};
+
+	auto i = std::size_t(0);
+	for(; i + 8 <= str.size(); i += 8) {
+		std::uint64_t w;
+		std::memcpy(&w, str.data() + i, 8);
+		add(w);
+	}
+
+	if(i < str.size()) {
+		std::uint64_t w = 0u;
+		std::memcpy(&w, str.data() + i, str.size() - i);
+		add(w);
+	}
+
+	return {hashMix(lo), hashMix(hi + lo)};
+}
+
+// Order-sensitive: hashCombine(hashCombine(s, a), b) differs from
+// hashCombine(hashCombine(s, b), a).
+inline Fingerprint hashCombine(Fingerprint seed, Fingerprint hash) {
+	return {
+		hashMix(seed.lo * 0x9e3779b97f4a7c15u + hash.lo),
+		hashMix((seed.hi ^ 0xc2b2ae3d27d4eb4fu) * 0xff51afd7ed558ccdu + hash.hi),
+	};
+}
+
+inline Fingerprint hashCombine(Fingerprint seed, std::uint64_t value) {
+	return hashCombine(seed, Fingerprint{value, value});
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+// Interning table for strings, e.g. table entry names.
+// Each distinct string is stored once, interned strings can be
+// compared by pointer. The storage is owned by the table and only
+// released in atom_table_destroy.
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#define ATOM_BLOCK_SIZE 4096
+
+struct atom_block {
+	struct atom_block* next;
+	size_t used;
+	size_t size;
+	char data[]; // 'size' bytes
+};
+
+struct atom_table {
+	unsigned n_atoms;
+	unsigned n_slots; // power of two or zero
+	const char** slots; // open addressing, NULL means empty
+	struct atom_block* blocks; // first one is the current one
+};
+
+uint32_t atom_hash(const char* str, size_t len) {
+	uint32_t hash = 2166136261u; // FNV-1a
+	for(size_t i = 0u; i < len; ++i) {
+		hash = (hash ^ (unsigned char) str[i]) * 16777619u;
+	}
+
+	return hash;
+}
+
+const char** atom_find_slot(const char** slots, unsigned n_slots,
+		const char* str, size_t len) {
+	unsigned i = atom_hash(str, len) & (n_slots - 1);
+	while(slots[i] && (strncmp(slots[i], str, len) || slots[i][len] != '\0')) {
+		i = (i + 1) & (n_slots - 1);
+	}
+
+	return &slots[i];
+}
+
+// Returns the canonical, null-terminated copy of the given string.
+const char* atom_intern(struct atom_table* table, const char* str, size_t len) {
+	// keep load factor <= 0.5
+	if(2 * (table->n_atoms + 1) > table->n_slots) {
+		unsigned n_slots = table->n_slots ? 2 * table->n_slots : 64u;
+		const char** slots = (const char**) calloc(n_slots, sizeof(*slots));
+		for(unsigned i = 0u; i < table->n_slots; ++i) {
+			const char* atom = table->slots[i];
+			if(atom) {
+				*atom_find_slot(slots, n_slots, atom, strlen(atom)) = atom;
+			}
+		}
+
+		free(table->slots);
+		table->slots = slots;
+		table->n_slots = n_slots;
+	}
+
+	const char** slot = atom_find_slot(table->slots, table->n_slots, str, len);
+	if(*slot) {
+		return *slot;
+	}
+
+	struct atom_block* block = table->blocks;
+	if(!block || block->size - block->used < len + 1) {
+		size_t size = len + 1 > ATOM_BLOCK_SIZE ? len + 1 : ATOM_BLOCK_SIZE;
+		block = (struct atom_block*) malloc(sizeof(*block) + size);
+		block->used = 0u;
+		block->size = size;
+		block->next = table->blocks;
+		table->blocks = block;
+	}
+
+	char* atom = block->data + block->used;
+	memcpy(atom, str, len);
+	atom[len] = '\0';
+	block->used += len + 1;
+
+	*slot = atom;
+	++table->n_atoms;
+	return atom;
+}
+
+void atom_table_destroy(struct atom_table* table) {
+	struct atom_block* block = table->blocks;
+	while(block) {
+		struct atom_block* next = block->next;
+		free(block);
+		block = next;
+	}
+
+	free(table->slots);
+	memset(table, 0, sizeof(*table));
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+// Interning table for strings, e.g. table keys that are repeated many
+// times in arrays of records. Every distinct string is stored once and
+// represented by an Atom: a small id plus a pointer to the canonical
+// storage. Atoms from the same table are compared by id.
+// See intern.h for the c version.
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+struct Atom {
+	std::uint32_t id {};
+	const std::string* str {}; // canonical storage, owned by the AtomTable
+
+	std::string_view view() const { return str ? *str : std::string_view{}; }
+	explicit operator bool() const { return str; }
+
+	friend bool operator==(Atom a, Atom b) { return a.id == b.id; }
+	friend bool operator!=(Atom a, Atom b) { return a.id != b.id; }
+};
+
+class AtomTable {
+public:
+	// Returns the atom for the given string, inserting it if needed.
+	Atom intern(std::string_view str) {
+		auto it = ids_.find(str);
+		if(it != ids_.end()) {
+			return {it->second, &strings_[it->second]};
+		}
+
+		auto id = std::uint32_t(strings_.size());
+		auto& stored = strings_.emplace_back(str);
+		ids_.emplace(stored, id);
+		return {id, &stored};
+	}
+
+	// Returns an empty atom if the string was never interned.
+	Atom find(std::string_view str) const {
+		auto it = ids_.find(str);
+		if(it == ids_.end()) {
+			return {};
+		}
+
+		return {it->second, &strings_[it->second]};
+	}
+
+	std::size_t size() const { return strings_.size(); }
+
+protected:
+	std::deque<std::string> strings_; // deque: stable references
+	std::unordered_map<std::string_view, std::uint32_t> ids_;
+};
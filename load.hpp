@@ -0,0 +1,250 @@
+#pragma once
+
+// Parallel loading of many files with any of the parsers.
+// The files are read and parsed on a bounded pool of worker threads,
+// each reusing its own read buffer. Results are returned in the order
+// of the given paths.
+//
+// Independent of the parser headers, the parser is passed as function:
+//
+// auto results = loadFiles(listFiles("config"), [](std::string_view content) {
+// 	Parser parser{content};
+// 	Error error;
+// 	auto table = parseTable(parser, error);
+// 	return std::pair{std::move(table), error.type};
+// });
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Compressed files, detected via magic bytes. Define LOAD_ZLIB (link
+// zlib) for gzip, LOAD_ZSTD (link libzstd) for zstd support.
+#ifdef LOAD_ZLIB
+	#include <zlib.h>
+#endif
+#ifdef LOAD_ZSTD
+	#include <zstd.h>
+#endif
+
+template<typename R>
+struct LoadResult {
+	std::string path;
+	std::optional<R> value; // empty if the file couldn't be read
+	std::string error; // why the file couldn't be read
+};
+
+// Returns all files with the given extension in the directory tree,
+// sorted, so the order is deterministic. Doesn't throw: on errors
+// (e.g. a missing 'dir') only the files found until then are returned.
+inline std::vector<std::string> listFiles(const std::string& dir,
+		std::string_view extension = ".qwe") {
+	std::vector<std::string> ret;
+	namespace fs = std::filesystem;
+	std::error_code ec;
+	auto it = fs::recursive_directory_iterator(dir,
+		fs::directory_options::skip_permission_denied, ec);
+	for(; !ec && it != fs::recursive_directory_iterator(); it.increment(ec)) {
+		if(it->is_regular_file(ec) && it->path().extension() == extension) {
+			ret.push_back(it->path().string());
+		}
+	}
+
+	std::sort(ret.begin(), ret.end());
+	return ret;
+}
+
+// Decodes the compressed 'file' chunk by chunk into 'buffer'.
+// 'chunk' holds the first 'count' bytes of the file.
+// The parsers need the whole content, only the decoded content is
+// kept in memory, never the whole compressed file.
+inline bool decodeInto(std::FILE* file, char* chunk, std::size_t chunkSize,
+		std::size_t count, std::string& buffer) {
+	constexpr unsigned char gzipMagic[] = {0x1f, 0x8b};
+	constexpr unsigned char zstdMagic[] = {0x28, 0xb5, 0x2f, 0xfd};
+	auto hasMagic = [&](const unsigned char* magic, std::size_t size) {
+		return count >= size && std::memcmp(chunk, magic, size) == 0;
+	};
+
+	if(hasMagic(gzipMagic, sizeof(gzipMagic))) {
+#ifdef LOAD_ZLIB
+		char out[64 * 1024];
+		z_stream zs {};
+		if(inflateInit2(&zs, 16 + MAX_WBITS) != Z_OK) {
+			return false;
+		}
+
+		auto ok = true;
+		auto pending = false; // inside a gzip member
+		while(count > 0u && ok) {
+			zs.next_in = reinterpret_cast<unsigned char*>(chunk);
+			zs.avail_in = uInt(count);
+			do {
+				zs.next_out = reinterpret_cast<unsigned char*>(out);
+				zs.avail_out = sizeof(out);
+				auto res = inflate(&zs, Z_NO_FLUSH);
+				buffer.append(out, sizeof(out) - zs.avail_out);
+				if(res == Z_STREAM_END) {
+					pending = false;
+					inflateReset(&zs); // there might be another member
+				} else if(res == Z_OK) {
+					pending = true;
+				} else if(res != Z_BUF_ERROR) {
+					ok = false;
+				}
+			} while(ok && (zs.avail_in > 0u || zs.avail_out == 0u));
+
+			count = std::fread(chunk, 1, chunkSize, file);
+		}
+
+		inflateEnd(&zs);
+		return ok && !pending && !std::ferror(file);
+#else
+		return false;
+#endif // LOAD_ZLIB
+	}
+
+	if(hasMagic(zstdMagic, sizeof(zstdMagic))) {
+#ifdef LOAD_ZSTD
+		char out[64 * 1024];
+		auto stream = ZSTD_createDStream();
+		if(!stream || ZSTD_isError(ZSTD_initDStream(stream))) {
+			ZSTD_freeDStream(stream);
+			return false;
+		}
+
+		auto res = std::size_t(0);
+		while(count > 0u) {
+			ZSTD_inBuffer in {chunk, count, 0};
+			while(in.pos < in.size) {
+				ZSTD_outBuffer zout {out, sizeof(out), 0};
+				res = ZSTD_decompressStream(stream, &zout, &in);
+				if(ZSTD_isError(res)) {
+					ZSTD_freeDStream(stream);
+					return false;
+				}
+
+				buffer.append(out, zout.pos);
+			}
+
+			count = std::fread(chunk, 1, chunkSize, file);
+		}
+
+		// flush remaining output
+		while(res != 0u) {
+			ZSTD_inBuffer in {chunk, 0, 0};
+			ZSTD_outBuffer zout {out, sizeof(out), 0};
+			res = ZSTD_decompressStream(stream, &zout, &in);
+			if(ZSTD_isError(res) || zout.pos == 0u) {
+				break;
+			}
+
+			buffer.append(out, zout.pos);
+		}
+
+		ZSTD_freeDStream(stream);
+		return res == 0u && !std::ferror(file);
+#else
+		return false;
+#endif // LOAD_ZSTD
+	}
+
+	// not compressed
+	while(count > 0u) {
+		buffer.append(chunk, count);
+		if(count < chunkSize) {
+			break;
+		}
+
+		count = std::fread(chunk, 1, chunkSize, file);
+	}
+
+	return !std::ferror(file);
+}
+
+// Reads the whole file into 'buffer', reusing its capacity.
+// Compressed files are decoded, see decodeInto.
+// Returns false if the file can't be read or decoded.
+inline bool readFileInto(const std::string& path, std::string& buffer) {
+	auto file = std::fopen(path.c_str(), "rb");
+	if(!file) {
+		return false;
+	}
+
+	buffer.clear();
+	char chunk[16 * 1024];
+	auto count = std::fread(chunk, 1, sizeof(chunk), file);
+	auto ok = decodeInto(file, chunk, sizeof(chunk), count, buffer);
+	std::fclose(file);
+	return ok;
+}
+
+// 'func' is called as 'func(std::string_view content)' on a worker thread.
+// Exceptions thrown by it are caught and stored in the result's 'error'.
+// The content is null-terminated (so it can be passed to parse_cb.h's
+// parse_string) but only valid during the call since the buffer is
+// reused: the returned value must not reference it.
+// 'threads' == 0 uses one thread per core.
+template<typename F>
+auto loadFiles(const std::vector<std::string>& paths, F&& func,
+		unsigned threads = 0u) {
+	using R = std::decay_t<std::invoke_result_t<F&, std::string_view>>;
+	std::vector<LoadResult<R>> results(paths.size());
+
+	if(threads == 0u) {
+		threads = std::max(std::thread::hardware_concurrency(), 1u);
+	}
+
+	threads = std::min<std::size_t>(threads, paths.size());
+
+	std::atomic<std::size_t> next {0u};
+	auto work = [&]{
+		std::string buffer;
+		while(true) {
+			auto i = next.fetch_add(1u, std::memory_order_relaxed);
+			if(i >= paths.size()) {
+				break;
+			}
+
+			auto& res = results[i];
+			res.path = paths[i];
+			if(!readFileInto(paths[i], buffer)) {
+				res.error = "Can't read file";
+				continue;
+			}
+
+			try {
+				res.value.emplace(func(std::string_view(buffer)));
+			} catch(const std::exception& err) {
+				res.error = err.what();
+			} catch(...) {
+				res.error = "Unknown exception";
+			}
+		}
+	};
+
+	std::vector<std::thread> workers;
+	workers.reserve(threads);
+	for(auto i = 1u; i < threads; ++i) {
+		workers.emplace_back(work);
+	}
+
+	if(threads > 0u) {
+		work(); // the calling thread is a worker as well
+	}
+
+	for(auto& worker : workers) {
+		worker.join();
+	}
+
+	return results;
+}
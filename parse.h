@@ -1,6 +1,8 @@
 #pragma once
 
 #include "data.h"
+#include "intern.h"
+#include "stats.h"
 #include <string.h>
 #include <stdlib.h>
 #include <stdbool.h>
@@ -17,7 +19,22 @@ struct location {
 
 struct parser {
 	const char* input;
-	location location;
+	struct location location;
+	struct parse_stats* stats; // optional
+
+	// Optional. When set, table entry names are interned into it instead
+	// of being allocated, duplicate names are detected by pointer
+	// comparison. The table must outlive the parsed values. These are
+	// flagged (see parser_value_flags), destroy_value won't free the
+	// names.
+	struct atom_table* atoms;
+
+	// In-situ mode: 'input' points to a writable buffer that outlives the
+	// parsed values. Delimiters in it are overwritten with null
+	// terminators and names and strings point directly into it instead
+	// of being copied. The values are flagged accordingly, destroy_value
+	// won't free them.
+	bool in_situ;
 };
 
 enum error_type {
@@ -44,12 +61,40 @@ struct parse_result {
 
 struct parse_result parse_value(struct parser* parser);
 
+// Flags of the values parsed with 'parser', see destroy_value_flags.
+unsigned parser_value_flags(const struct parser* parser) {
+	unsigned flags = value_flags_none;
+	if(parser->atoms || parser->in_situ) {
+		flags |= value_flags_borrowed_names;
+	}
+
+	if(parser->in_situ) {
+		flags |= value_flags_borrowed_strings;
+	}
+
+	return flags;
+}
+
+// realloc that is recorded in parser->stats
+void* parser_realloc(struct parser* parser, void* ptr, size_t size) {
+	if(parser->stats) {
+		++parser->stats->allocations;
+		parser->stats->allocated_bytes += size;
+	}
+
+	return realloc(ptr, size);
+}
+
 struct parse_result parse_table_or_array(struct parser* parser) {
 	struct value parsed = {
 		.type = value_type_string, // don't know yet if vector or table
+		.flags = parser_value_flags(parser),
 		// rest is zero-initialized
 	};
 
+	struct parse_stats* stats = parser->stats;
+	const char* begin = parser->input; // for stats
+
 	while(parser->input && parser->input[0] != '\0') {
 		const char* start = parser->input;
 		while(start[0] != '\0' && start[0] == '\t') {
@@ -68,6 +113,10 @@ struct parse_result parse_table_or_array(struct parser* parser) {
 				break;
 			}
 
+			if(stats) {
+				++stats->comment_lines;
+			}
+
 			++parser->location.line;
 			parser->location.col = 0u;
 			parser->input = nl + 1;
@@ -76,6 +125,10 @@ struct parse_result parse_table_or_array(struct parser* parser) {
 
 		// empty lines are also always allowd
 		if(start[0] == '\n') {
+			if(stats) {
+				++stats->blank_lines;
+			}
+
 			++parser->location.line;
 			parser->location.col = 0u;
 			parser->input = start + 1;
@@ -86,7 +139,7 @@ struct parse_result parse_table_or_array(struct parser* parser) {
 
 		// indentation is suddenly too high
 		if(indent > parser->location.nest_depth) {
-			destroy_value(&parsed);
+			destroy_value_flags(&parsed, parser_value_flags(parser));
 			return (struct parse_result){
 				.success = false,
 				.error = {
@@ -108,10 +161,10 @@ struct parse_result parse_table_or_array(struct parser* parser) {
 			break;
 		}
 
-		location ploc = parser->location; // save it for later
-		parse_result res = parse_value(parser);
+		struct location ploc = parser->location; // save it for later
+		struct parse_result res = parse_value(parser);
 		if(!res.success) {
-			destroy_value(&parsed);
+			destroy_value_flags(&parsed, parser_value_flags(parser));
 			return res;
 		}
 
@@ -120,9 +173,11 @@ struct parse_result parse_table_or_array(struct parser* parser) {
 		if(parsed.type == value_type_string) { // dummy value for first entry
 			parsed.type = type;
 		} else if(parsed.type != type) {
-			destroy_value(&parsed);
-			destroy_value(&res.value.value);
-			free((void*) res.value.name);
+			destroy_value_flags(&parsed, parser_value_flags(parser));
+			destroy_value_flags(&res.value.value, parser_value_flags(parser));
+			if(!(parser_value_flags(parser) & value_flags_borrowed_names)) {
+				free((void*) res.value.name);
+			}
 
 			return (struct parse_result){
 				.success = false,
@@ -134,16 +189,22 @@ struct parse_result parse_table_or_array(struct parser* parser) {
 		}
 
 		if(parsed.type == value_type_vector) {
-			vector* v = &parsed.vector;
+			struct vector* v = &parsed.vector;
 			++v->n_values;
 			size_t nsize = sizeof(*v->values) * v->n_values;
-			v->values = (struct value*) realloc(v->values, nsize);
+			v->values = (struct value*) parser_realloc(parser,
+				v->values, nsize);
 			v->values[v->n_values - 1] = res.value.value;
 		} else { // table
 			// check for duplicate entry
-			table* t = &parsed.table;
+			struct table* t = &parsed.table;
 			for(size_t i = 0u; i < t->n_entries; ++i) {
-				if(!strcmp(t->entries[i].name, res.value.name)) {
+				const char* name = t->entries[i].name;
+				if(parser->atoms ? name == res.value.name :
+						!strcmp(name, res.value.name)) {
+					// the name is kept as error data
+					destroy_value_flags(&parsed, parser_value_flags(parser));
+					destroy_value_flags(&res.value.value, parser_value_flags(parser));
 					return (struct parse_result) {
 						.success = false,
 						.error = {
@@ -158,7 +219,8 @@ struct parse_result parse_table_or_array(struct parser* parser) {
 			// insert
 			++t->n_entries;
 			size_t nsize = sizeof(*t->entries) * t->n_entries;
-			t->entries = (struct table_entry*) realloc(t->entries, nsize);
+			t->entries = (struct table_entry*) parser_realloc(parser,
+				t->entries, nsize);
 			t->entries[t->n_entries - 1] = res.value;
 		}
 	}
@@ -174,6 +236,20 @@ struct parse_result parse_table_or_array(struct parser* parser) {
 		};
 	}
 
+	if(stats) {
+		if(parsed.type == value_type_vector) {
+			stats->entries += parsed.vector.n_values;
+			++stats->arrays;
+		} else {
+			stats->entries += parsed.table.n_entries;
+			++stats->tables;
+		}
+
+		if(parser->location.nest_depth == 0u) {
+			stats->bytes += parser->input - begin;
+		}
+	}
+
 	return (struct parse_result) {
 		.success = true,
 		.value = {NULL, parsed},
@@ -192,7 +268,7 @@ struct parse_result parse_value(struct parser* parser) {
 	}
 
 	const char* after = "\0";
-	location after_loc = parser->location;
+	struct location after_loc = parser->location;
 	const char* nl = strchr(parser->input, '\n');
 	if(nl) {
 		after = nl + 1;
@@ -200,17 +276,21 @@ struct parse_result parse_value(struct parser* parser) {
 		++after_loc.line;
 	}
 
-	const char* sep = strchr(parser->input, ':');
-	if(nl && sep > nl) {
-		sep = NULL;
-	}
+	// only search the current line, not the whole input
+	size_t line_len = nl ? (size_t) (nl - parser->input) : strlen(parser->input);
+	const char* sep = (const char*) memchr(parser->input, ':', line_len);
 
 	// we just have a single string value
 	if(!sep) {
-		size_t buf_size = nl ? nl - parser->input : strlen(parser->input);
-		char* buf = (char*) malloc(buf_size + 1);
-		memcpy(buf, parser->input, buf_size);
-		buf[buf_size] = '\0';
+		char* buf;
+		if(parser->in_situ) {
+			buf = (char*) parser->input;
+		} else {
+			buf = (char*) parser_realloc(parser, NULL, line_len + 1);
+			memcpy(buf, parser->input, line_len);
+		}
+
+		buf[line_len] = '\0';
 
 		parser->input = after;
 		parser->location = after_loc;
@@ -220,6 +300,7 @@ struct parse_result parse_value(struct parser* parser) {
 				.name = NULL,
 				.value = {
 					.type = value_type_string,
+					.flags = parser_value_flags(parser),
 					.string = buf,
 				}
 			}
@@ -245,9 +326,17 @@ struct parse_result parse_value(struct parser* parser) {
 	}
 
 	unsigned name_len = 1 + name_last - name;
-	char* name_buf = (char*) malloc(name_len + 1);
-	memcpy(name_buf, name, name_len);
-	name_buf[name_len] = '\0';
+	const char* name_buf;
+	if(parser->atoms) {
+		name_buf = atom_intern(parser->atoms, name, name_len);
+	} else if(parser->in_situ) {
+		name_buf = name; // terminated below, 'sep' is still needed
+	} else {
+		char* buf = (char*) parser_realloc(parser, NULL, name_len + 1);
+		memcpy(buf, name, name_len);
+		buf[name_len] = '\0';
+		name_buf = buf;
+	}
 
 	const char* value = sep + 1;
 	// remove whitespace prefix in value
@@ -259,11 +348,20 @@ struct parse_result parse_value(struct parser* parser) {
 	}
 
 	unsigned value_len = nl ? nl - value : strlen(value);
+	if(parser->in_situ && !parser->atoms) {
+		((char*) name)[name_len] = '\0'; // overwrites ':'
+	}
 
 	// Value is not empty. We have found a table entry
 	if(value_len > 0) {
-		char* val_buf = (char*) malloc(value_len + 1);
-		memcpy(val_buf, value, value_len);
+		char* val_buf;
+		if(parser->in_situ) {
+			val_buf = (char*) value;
+		} else {
+			val_buf = (char*) parser_realloc(parser, NULL, value_len + 1);
+			memcpy(val_buf, value, value_len);
+		}
+
 		val_buf[value_len] = '\0';
 
 		parser->input = after;
@@ -274,6 +372,7 @@ struct parse_result parse_value(struct parser* parser) {
 				.name = name_buf,
 				.value = {
 					.type = value_type_string,
+					.flags = parser_value_flags(parser),
 					.string = val_buf,
 				}
 			}
@@ -291,8 +390,12 @@ struct parse_result parse_value(struct parser* parser) {
 	struct location* l = &parser->location;
 	size_t nd = ++l->nest_depth;
 	size_t nsize = sizeof(*l->nest_tables) * l->nest_depth;
-	l->nest_tables = (const char**) realloc(l->nest_tables, nsize);
+	l->nest_tables = (const char**) parser_realloc(parser,
+		l->nest_tables, nsize);
 	l->nest_tables[l->nest_depth - 1] = name_buf;
+	if(parser->stats && l->nest_depth > parser->stats->max_depth) {
+		parser->stats->max_depth = l->nest_depth;
+	}
 
 	struct parse_result res = parse_table_or_array(parser);
 	if(!res.success) {
@@ -1,7 +1,11 @@
 #pragma once
 
+#include "blob.hpp"
 #include "common.hpp"
 #include "data.hpp"
+#include "stats.hpp"
+#include <algorithm>
+#include <charconv>
 #include <optional>
 
 struct Location {
@@ -13,6 +17,23 @@ struct Location {
 struct Parser {
 	std::string_view input;
 	Location location {};
+
+	// Dotted paths (e.g. "mie.scattering") of the subtrees to parse.
+	// Values that can't lie on or inside any of them are skipped,
+	// nested ones without being tokenized. Empty: parse everything.
+	std::vector<std::string_view> projection {};
+
+	ParseStats* stats {}; // optional
+
+	// Where pmr::Values are allocated from. Default resource if null.
+	std::pmr::memory_resource* memory {};
+
+	// Store arrays whose items are all plain numbers as Integers or
+	// Numbers (see data.hpp) instead of vectors of strings, dropping
+	// their original text. Arrays with a blob (see blob.hpp) as only
+	// item are decoded into them as well. Only supported for Value.
+	// Off by default, i.e. the text is kept unless this is requested.
+	bool numericArrays {};
 };
 
 enum class ErrorType {
@@ -31,20 +52,177 @@ struct Error {
 	std::string_view data {}; // dependent on 'type'
 };
 
-struct NamedValue {
-	Value value;
+template<typename V>
+struct BasicNamedValue {
+	V value;
 	std::string_view name {}; // optional, might be empty
+	bool skipped {}; // not part of the projection, 'value' is empty
 };
 
-using ParseResult = std::variant<NamedValue, Error>;
+template<typename V>
+using BasicParseResult = std::variant<BasicNamedValue<V>, Error>;
+
+using NamedValue = BasicNamedValue<Value>;
+using ParseResult = BasicParseResult<Value>;
+
+// Construction of the values of a data model, either Value or
+// pmr::Value, see data.hpp.
+template<typename V> struct DataModel;
+
+template<> struct DataModel<Value> {
+	using Table = ::Table;
+	using Vector = ::Vector;
+
+	static Value string(Parser&, std::string_view str) {
+		return {std::string(str)};
+	}
+
+	static Table table(Parser&) { return {}; }
+	static Vector vector(Parser&) { return {}; }
+	static auto ptr(Parser&, Value&& value) {
+		return std::make_unique<Value>(std::move(value));
+	}
+};
+
+template<> struct DataModel<pmr::Value> {
+	using Table = pmr::Table;
+	using Vector = pmr::Vector;
+
+	static std::pmr::memory_resource* memory(Parser& parser) {
+		return parser.memory ? parser.memory : std::pmr::get_default_resource();
+	}
+
+	static pmr::Value string(Parser& parser, std::string_view str) {
+		return {std::pmr::string(str, memory(parser))};
+	}
+
+	static Table table(Parser& parser) { return Table(memory(parser)); }
+	static Vector vector(Parser& parser) { return Vector(memory(parser)); }
+	static auto ptr(Parser& parser, pmr::Value&& value) {
+		return pmr::makeValue(memory(parser), std::move(value));
+	}
+};
+
+// Matches the path given by the parsers current nesting and 'name'
+// (optional, might be empty) against the projected paths.
+inline PathMatch matchProjection(const Parser& parser, std::string_view name) {
+	auto& nest = parser.location.nest;
+	return matchPaths(parser.projection.data(), parser.projection.size(),
+		nest.data(), nest.size(), name.empty() ? nullptr : &name);
+}
+
+// Skips all lines belonging to the value at the current nesting
+// level, see skipIndented. Returns an error if the value is empty,
+// like parsing it would.
+inline std::optional<Error> skipValue(Parser& parser) {
+	if(!skipIndented(parser.input, parser.location.nest.size(),
+			parser.location.line, parser.location.col)) {
+		return Error{ErrorType::mixedTableArray, parser.location};
+	}
+
+	return std::nullopt;
+}
+
+// Whether 'text' is a number in its entirety, e.g. "-1.5e3" but not
+// "1.5 m", "+1" or "inf".
+inline bool isNumberText(std::string_view text) {
+	auto digits = text.substr(!text.empty() && text[0] == '-');
+	if(digits.empty() || !((digits[0] >= '0' && digits[0] <= '9') || digits[0] == '.')) {
+		return false;
+	}
 
-ParseResult parse(Parser& parser);
-ParseResult parseTableOrArray(Parser& parser) {
+	double number;
+	auto end = text.data() + text.size();
+	auto res = std::from_chars(text.data(), end, number);
+	return res.ec == std::errc{} && res.ptr == end;
+}
+
+// Converts the items of a numeric array, see Parser::numericArrays.
+// The items are numbers or blobs. Returns nullopt if the array can't
+// be converted (a blob that isn't the only item, is invalid or has
+// unsigned items beyond int64).
+inline std::optional<Value> numericArray(const std::vector<std::string_view>& items) {
+	auto isBlob = [](std::string_view item) { return item[0] == '@'; };
+	if(items.size() == 1u && isBlob(items[0])) {
+		auto blob = parseBlob(items[0]);
+		auto decode = [&](auto&& numbers) -> std::optional<Value> {
+			numbers.resize(blob->count);
+			if(!decodeBlob(*blob, numbers.data())) {
+				return std::nullopt;
+			}
+
+			return Value{std::move(numbers)};
+		};
+
+		auto type = blob->type;
+		return (type == BlobType::f32 || type == BlobType::f64) ?
+			decode(Numbers{}) : decode(Integers{});
+	}
+
+	if(std::any_of(items.begin(), items.end(), isBlob)) {
+		return std::nullopt;
+	}
+
+	Integers integers;
+	integers.reserve(items.size());
+	for(auto item : items) {
+		std::int64_t number;
+		auto end = item.data() + item.size();
+		auto res = std::from_chars(item.data(), end, number);
+		if(res.ec != std::errc{} || res.ptr != end) {
+			break;
+		}
+
+		integers.push_back(number);
+	}
+
+	if(integers.size() == items.size()) {
+		return Value{std::move(integers)};
+	}
+
+	Numbers numbers;
+	numbers.reserve(items.size());
+	for(auto item : items) {
+		auto& number = numbers.emplace_back();
+		std::from_chars(item.data(), item.data() + item.size(), number);
+	}
+
+	return Value{std::move(numbers)};
+}
+
+// The data model is chosen via 'V', either Value or pmr::Value.
+template<typename V = Value> BasicParseResult<V> parse(Parser& parser);
+
+template<typename V = Value>
+BasicParseResult<V> parseTableOrArray(Parser& parser) {
 	using std::move;
+	using Model = DataModel<V>;
+
+	StatsScope statsScope(parser.stats, &parser.input);
+	auto* stats = parser.stats;
 
 	std::optional<bool> isTable;
-	Table table;
-	Vector vector;
+	auto table = Model::table(parser);
+	auto vector = Model::vector(parser);
+	auto arrayItems = 0u; // including skipped ones
+
+	// Text of the items as long as all of them are numbers,
+	// see Parser::numericArrays.
+	auto numeric = std::is_same_v<V, Value> && parser.numericArrays;
+	std::vector<std::string_view> numbers;
+	auto flushNumbers = [&]{
+		if(numeric) {
+			numeric = false;
+			for(auto text : numbers) {
+				vector.push_back(Model::ptr(parser, Model::string(parser, text)));
+			}
+		}
+	};
+
+	auto pushItem = [&](auto&& item) {
+		flushNumbers();
+		vector.push_back(std::move(item));
+	};
 	while(!parser.input.empty()) {
 		auto after = parser.input;
 
@@ -67,6 +245,10 @@ ParseResult parseTableOrArray(Parser& parser) {
 				break;
 			}
 
+			if(stats) {
+				++stats->commentLines;
+			}
+
 			++parser.location.line;
 			parser.location.col = 0u;
 			parser.input = after.substr(nl + 1);
@@ -75,6 +257,10 @@ ParseResult parseTableOrArray(Parser& parser) {
 
 		// Empty lines are also always allowed
 		if(after[first] == '\n') {
+			if(stats) {
+				++stats->blankLines;
+			}
+
 			++parser.location.line;
 			parser.location.col = 0u;
 			parser.input = after.substr(first + 1);
@@ -107,35 +293,93 @@ ParseResult parseTableOrArray(Parser& parser) {
 
 			parser.location.col = 0u;
 			++parser.location.line;
-			parser.location.nest.push_back(std::to_string(vector.size()));
 			isTable = {false};
 
-			auto res = parseTableOrArray(parser);
+			// must outlive the nest entry
+			auto index = std::to_string(arrayItems++);
+			if(!parser.projection.empty() &&
+					matchProjection(parser, index) == PathMatch::none) {
+				parser.location.nest.push_back(index);
+				if(auto err = skipValue(parser)) {
+					return {*err};
+				}
+
+				parser.location.nest.pop_back();
+				continue;
+			}
+
+			parser.location.nest.push_back(index);
+			countDepth(stats, parser.location.nest.size());
+			auto res = parseTableOrArray<V>(parser);
 			if(auto err = std::get_if<Error>(&res)) {
 				return {*err};
 			}
 
 			parser.location.nest.pop_back();
-			auto& nv = std::get<NamedValue>(res);
-			vector.push_back(std::make_unique<Value>(std::move(nv.value)));
+			auto& nv = std::get<BasicNamedValue<V>>(res);
+			pushItem(Model::ptr(parser, std::move(nv.value)));
+			if(stats) {
+				++stats->entries;
+			}
 			continue;
 		}
 
+		// plain number as array item, handled like in parse but
+		// without allocating a string
+		if(numeric && isTable != std::optional(true)) {
+			auto nl = parser.input.find('\n');
+			auto line = parser.input.substr(0, nl);
+			if(isNumberText(line) || parseBlob(line)) {
+				if(nl == parser.input.npos) {
+					parser.input = {};
+				} else {
+					parser.input = parser.input.substr(nl + 1);
+					parser.location.col = 0u;
+					++parser.location.line;
+				}
+
+				isTable = {false};
+				++arrayItems;
+				if(!parser.projection.empty() &&
+						matchProjection(parser, {}) != PathMatch::inside) {
+					continue;
+				}
+
+				if(stats) {
+					++stats->entries;
+				}
+
+				numbers.push_back(line);
+				continue;
+			}
+		}
+
 		auto ploc = parser.location; // save it for later
-		auto res = parse(parser);
+		auto res = parse<V>(parser);
 		if(auto err = std::get_if<Error>(&res)) {
 			return {*err};
 		}
 
-		auto& nv = std::get<NamedValue>(res);
+		auto& nv = std::get<BasicNamedValue<V>>(res);
 		if(isTable && *isTable == nv.name.empty()) {
 			return Error{ErrorType::mixedTableArray, ploc};
 		}
 
-		auto v = std::make_unique<Value>(move(nv.value));
+		if(nv.skipped) {
+			arrayItems += nv.name.empty();
+			isTable = {!nv.name.empty()};
+			continue;
+		}
+
+		if(stats) {
+			++stats->entries;
+		}
+
+		auto v = Model::ptr(parser, move(nv.value));
 		if(nv.name.empty()) {
 			isTable = {false};
-			vector.push_back(move(v));
+			++arrayItems;
+			pushItem(move(v));
 		} else {
 			isTable = {true};
 			if(!table.emplace(nv.name, std::move(v)).second) {
@@ -148,13 +392,33 @@ ParseResult parseTableOrArray(Parser& parser) {
 		return Error{ErrorType::mixedTableArray, parser.location};
 	}
 
-	NamedValue nv;
-	nv.value = *isTable ? Value{{move(table)}} : Value{{move(vector)}};
+	if(stats) {
+		++(*isTable ? stats->tables : stats->arrays);
+	}
+
+	BasicNamedValue<V> nv;
+	if(*isTable) {
+		nv.value.value = move(table);
+	} else if(numeric && !numbers.empty()) {
+		if constexpr(std::is_same_v<V, Value>) {
+			if(auto value = numericArray(numbers)) {
+				nv.value = std::move(*value);
+			} else {
+				flushNumbers();
+				nv.value.value = move(vector);
+			}
+		}
+	} else {
+		nv.value.value = move(vector);
+	}
+
 	return nv;
 }
 
-ParseResult parse(Parser& parser) {
+template<typename V>
+BasicParseResult<V> parse(Parser& parser) {
 	using std::move;
+	using Model = DataModel<V>;
 	// constexpr auto whitespace = "\n\t\f\r\v "; // as by std::isspace
 
 	if(parser.input.empty()) {
@@ -177,7 +441,12 @@ ParseResult parse(Parser& parser) {
 	if(sep == parser.input.npos) {
 		parser.input = after;
 		parser.location = afterLoc;
-		return NamedValue{Value{std::string(line)}};
+		if(!parser.projection.empty() &&
+				matchProjection(parser, {}) != PathMatch::inside) {
+			return BasicNamedValue<V>{{}, {}, true};
+		}
+
+		return BasicNamedValue<V>{Model::string(parser, line)};
 	}
 
 	auto [name, val] = split(line, sep);
@@ -202,10 +471,28 @@ ParseResult parse(Parser& parser) {
 		return Error{ErrorType::emptyName, parser.location};
 	}
 
+	auto match = PathMatch::inside;
+	if(!parser.projection.empty()) {
+		match = matchProjection(parser, name);
+	}
+
 	if(!val.empty()) { // table assignment
 		parser.input = after;
 		parser.location = afterLoc;
-		return NamedValue{Value{std::string(val)}, name};
+		if(match != PathMatch::inside) {
+			return BasicNamedValue<V>{{}, name, true};
+		}
+
+		// inline blob, see Parser::numericArrays
+		if constexpr(std::is_same_v<V, Value>) {
+			if(parser.numericArrays && parseBlob(val)) {
+				if(auto value = numericArray({val})) {
+					return BasicNamedValue<V>{std::move(*value), name};
+				}
+			}
+		}
+
+		return BasicNamedValue<V>{Model::string(parser, val), name};
 	}
 
 	// if it's neither a table assignment or an array value,
@@ -213,8 +500,18 @@ ParseResult parse(Parser& parser) {
 	parser.input = after;
 	parser.location = afterLoc;
 	parser.location.nest.push_back(name);
+	countDepth(parser.stats, parser.location.nest.size());
 
-	auto res = parseTableOrArray(parser);
+	if(match == PathMatch::none) {
+		if(auto err = skipValue(parser)) {
+			return {*err};
+		}
+
+		parser.location.nest.pop_back();
+		return BasicNamedValue<V>{{}, name, true};
+	}
+
+	auto res = parseTableOrArray<V>(parser);
 	assert(parser.location.nest.back() == name);
 	parser.location.nest.pop_back();
 
@@ -222,9 +519,16 @@ ParseResult parse(Parser& parser) {
 		return *err;
 	}
 
-	auto& nv = std::get<NamedValue>(res);
+	auto& nv = std::get<BasicNamedValue<V>>(res);
 	assert(nv.name.empty());
 
 	nv.name = name;
 	return {std::move(nv)};
 }
+
+// Parses the document into a pmr::Value allocated from 'memory'.
+inline BasicParseResult<pmr::Value> parseTableOrArray(Parser& parser,
+		std::pmr::memory_resource* memory) {
+	parser.memory = memory;
+	return parseTableOrArray<pmr::Value>(parser);
+}
@@ -6,6 +6,22 @@
 #include <stdbool.h>
 #include <ctype.h> // isspace
 #include <assert.h> // TODO
+#include "stats.h"
+
+// Define PARSE_CB_NO_READ_AHEAD to build without pthreads.
+#ifndef PARSE_CB_NO_READ_AHEAD
+	#include <pthread.h>
+#endif
+
+// Compressed input for the read-ahead, detected via magic bytes.
+// Define PARSE_CB_ZLIB (link zlib) for gzip, PARSE_CB_ZSTD (link
+// libzstd) for zstd support.
+#ifdef PARSE_CB_ZLIB
+	#include <zlib.h>
+#endif
+#ifdef PARSE_CB_ZSTD
+	#include <zstd.h>
+#endif
 
 #define NEST_SEP "."
 #define ARRAY_SEP "."
@@ -13,6 +29,11 @@
 #define MAX_LINE_SIZE 512
 #define MAX_NEST_SIZE 512
 
+#ifndef READ_AHEAD_BLOCK_SIZE
+	#define READ_AHEAD_BLOCK_SIZE (64 * 1024)
+#endif
+#define READ_AHEAD_BLOCKS 3
+
 // API
 struct parser;
 typedef void (*parse_func)(struct parser* parser,
@@ -22,6 +43,42 @@ typedef void (*parse_func)(struct parser* parser,
 // Must return NULL on error.
 typedef char*(*read_func)(struct parser* parser);
 
+// Opt-in batched delivery: instead of calling parse_func for every value,
+// events are collected into a caller-provided array and passed to
+// a parse_batch_func when the array (or the string storage) is full
+// and at the end of input.
+struct parse_event {
+	const char* name; // NULL for array values
+	const char* value;
+	// Shared between consecutive events in the same table or array,
+	// i.e. with the identical nest string. Events of other tables get
+	// their own copy, even if their nest shares a prefix.
+	const char* nest;
+	unsigned nest_len;
+	unsigned line;
+};
+
+typedef void (*parse_batch_func)(struct parser* parser,
+	const struct parse_event* events, unsigned count);
+
+struct parse_batch {
+	parse_batch_func cb;
+	struct parse_event* events;
+	unsigned capacity;
+
+	// Storage for the strings referenced by the events.
+	// Must be able to hold at least MAX_LINE_SIZE + MAX_NEST_SIZE bytes,
+	// capacity must not be 0. Otherwise the batched parse functions
+	// fail with error_type_invalid_batch.
+	char* data;
+	size_t data_size;
+
+	// state, reset by parse_file_batched/parse_string_batched
+	unsigned count;
+	size_t data_len;
+	const char* nest; // current nest_buf copied into data, NULL if none
+};
+
 struct location {
 	unsigned line;
 	unsigned col;
@@ -42,6 +99,20 @@ struct parser {
 
 	read_func read;
 	void* stream;
+
+	// Optional projection: dotted paths (e.g. "mie.scattering") of the
+	// subtrees to parse. Nested values that can't lie on or inside any
+	// of them are skipped without tokenizing them, other values outside
+	// of them are not passed to the callback.
+	const char* const* projection;
+	unsigned n_projection;
+
+	// Optional, see parse_batch.
+	struct parse_batch* batch;
+
+	// Optional. Since nothing is allocated, only the structure
+	// and scanned bytes are recorded.
+	struct parse_stats* stats;
 };
 
 enum error_type {
@@ -53,6 +124,8 @@ enum error_type {
 	error_type_empty_table_array = 5,
 	error_type_nest_too_long = 6,
 	error_type_line_too_long = 7,
+	error_type_read_failed = 8, // I/O or decoding error
+	error_type_invalid_batch = 9, // parse_batch too small, see there
 };
 
 struct parse_result {
@@ -64,6 +137,77 @@ struct parse_result parse_from_file(FILE* file, parse_func func, void* user);
 struct parse_result parse_file(const char* filename, parse_func func, void* user);
 struct parse_result parse_string(const char* str, parse_func func, void* user);
 
+// Like parse_file but only parses the given projection, see
+// parser.projection.
+struct parse_result parse_file_projected(const char* filename,
+	const char* const* projection, unsigned n_projection,
+	parse_func func, void* user);
+
+// Like parse_file/parse_string but with batched delivery, see parse_batch.
+struct parse_result parse_file_batched(const char* filename,
+	struct parse_batch* batch, void* user);
+struct parse_result parse_string_batched(const char* str,
+	struct parse_batch* batch, void* user);
+
+#ifndef PARSE_CB_NO_READ_AHEAD
+enum read_ahead_format {
+	read_ahead_format_raw,
+	read_ahead_format_gzip, // needs PARSE_CB_ZLIB
+	read_ahead_format_zstd, // needs PARSE_CB_ZSTD
+};
+
+// Read-ahead: a background thread reads the file in blocks into a ring
+// of READ_AHEAD_BLOCKS buffers while the parser tokenizes the lines of
+// the blocks already read. Can be used with any of the parser options:
+// start it and set parser.read = parser_read_ahead,
+// parser.stream = the read_ahead.
+// Compressed files are decoded on the thread as well, block by block.
+// The decompressed file is never held in memory as a whole.
+struct read_ahead {
+	FILE* file;
+	pthread_t thread;
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+
+	// protected by mutex
+	unsigned filled; // blocks read but not yet consumed
+	bool done; // reached end of file or error
+	bool error;
+	bool stop; // the reader should stop, set by read_ahead_stop
+
+	// only accessed by the reader while not counted in filled
+	char blocks[READ_AHEAD_BLOCKS][READ_AHEAD_BLOCK_SIZE];
+	size_t sizes[READ_AHEAD_BLOCKS];
+
+	// reader state: file content not yet decoded
+	enum read_ahead_format format;
+	bool decode_error;
+	bool decode_pending; // inside a compressed frame
+	unsigned char in_buf[READ_AHEAD_BLOCK_SIZE];
+	size_t in_len;
+	size_t in_pos;
+#ifdef PARSE_CB_ZLIB
+	z_stream zs;
+#endif
+#ifdef PARSE_CB_ZSTD
+	ZSTD_DStream* zstd;
+#endif
+
+	// consumer state
+	unsigned current; // block the parser reads from
+	size_t pos; // position in the current block
+	bool has_block; // whether 'current' was already waited for
+};
+
+bool read_ahead_start(struct read_ahead* ra, FILE* file);
+void read_ahead_stop(struct read_ahead* ra);
+char* parser_read_ahead(struct parser* parser);
+
+// Like parse_file but reads ahead, see read_ahead.
+struct parse_result parse_file_read_ahead(const char* filename,
+	parse_func func, void* user);
+#endif // PARSE_CB_NO_READ_AHEAD
+
 // Implementation
 char* parser_read_fgets(struct parser* parser) {
 	return fgets(parser->line_buf, sizeof(parser->line_buf), (FILE*) parser->stream);
@@ -94,13 +238,476 @@ char* parser_read_mem(struct parser* parser) {
 	return buf;
 }
 
+#ifndef PARSE_CB_NO_READ_AHEAD
+// Makes sure that there is undecoded input in in_buf.
+// Returns false at the end of the file.
+bool read_ahead_input(struct read_ahead* ra) {
+	if(ra->in_pos < ra->in_len) {
+		return true;
+	}
+
+	ra->in_pos = 0u;
+	ra->in_len = fread(ra->in_buf, 1, sizeof(ra->in_buf), ra->file);
+	return ra->in_len > 0u;
+}
+
+// Detects the format from the first 'len' bytes of the file.
+enum read_ahead_format read_ahead_detect(const unsigned char* buf, size_t len) {
+	static const unsigned char gzip_magic[] = {0x1f, 0x8b};
+	static const unsigned char zstd_magic[] = {0x28, 0xb5, 0x2f, 0xfd};
+
+	if(len >= sizeof(gzip_magic) && !memcmp(buf, gzip_magic, sizeof(gzip_magic))) {
+		return read_ahead_format_gzip;
+	}
+
+	if(len >= sizeof(zstd_magic) && !memcmp(buf, zstd_magic, sizeof(zstd_magic))) {
+		return read_ahead_format_zstd;
+	}
+
+	return read_ahead_format_raw;
+}
+
+// Detects the format and sets up the decoder.
+// Returns false if the format is not supported.
+bool read_ahead_init_decoder(struct read_ahead* ra) {
+	ra->decode_error = false;
+	ra->decode_pending = false;
+	ra->in_len = 0u;
+	ra->in_pos = 0u;
+	read_ahead_input(ra);
+
+	ra->format = read_ahead_detect(ra->in_buf, ra->in_len);
+	if(ra->format == read_ahead_format_gzip) {
+#ifdef PARSE_CB_ZLIB
+		memset(&ra->zs, 0, sizeof(ra->zs));
+		return inflateInit2(&ra->zs, 16 + MAX_WBITS) == Z_OK;
+#else
+		return false;
+#endif
+	}
+
+	if(ra->format == read_ahead_format_zstd) {
+#ifdef PARSE_CB_ZSTD
+		ra->zstd = ZSTD_createDStream();
+		return ra->zstd && !ZSTD_isError(ZSTD_initDStream(ra->zstd));
+#else
+		return false;
+#endif
+	}
+
+	return true;
+}
+
+void read_ahead_destroy_decoder(struct read_ahead* ra) {
+#ifdef PARSE_CB_ZLIB
+	if(ra->format == read_ahead_format_gzip) {
+		inflateEnd(&ra->zs);
+	}
+#endif
+#ifdef PARSE_CB_ZSTD
+	if(ra->format == read_ahead_format_zstd) {
+		ZSTD_freeDStream(ra->zstd);
+	}
+#endif
+	(void) ra;
+}
+
+// Fills 'dst' with the next 'size' bytes of (decoded) content.
+// Returns less than 'size' only at the end of input or on error.
+size_t read_ahead_decode(struct read_ahead* ra, char* dst, size_t size) {
+	size_t count = 0u;
+	while(count < size && !ra->decode_error) {
+		// the decoder may still have buffered output without new input
+		bool has_input = read_ahead_input(ra);
+		if(!has_input && !ra->decode_pending) {
+			break;
+		}
+
+		size_t before = count;
+		const unsigned char* in = ra->in_buf + ra->in_pos;
+		size_t in_len = ra->in_len - ra->in_pos;
+
+		if(ra->format == read_ahead_format_raw) {
+			size_t n = in_len < size - count ? in_len : size - count;
+			memcpy(dst + count, in, n);
+			count += n;
+			ra->in_pos += n;
+		}
+
+#ifdef PARSE_CB_ZLIB
+		if(ra->format == read_ahead_format_gzip) {
+			ra->zs.next_in = (unsigned char*) in;
+			ra->zs.avail_in = (uInt) in_len;
+			ra->zs.next_out = (unsigned char*) dst + count;
+			ra->zs.avail_out = (uInt) (size - count);
+			int res = inflate(&ra->zs, Z_NO_FLUSH);
+			count = size - ra->zs.avail_out;
+			ra->in_pos = ra->in_len - ra->zs.avail_in;
+			ra->decode_pending = (res != Z_STREAM_END);
+			if(res == Z_STREAM_END) {
+				// there might be another gzip member
+				inflateReset(&ra->zs);
+			} else if(res != Z_OK && res != Z_BUF_ERROR) {
+				ra->decode_error = true;
+			}
+		}
+#endif
+
+#ifdef PARSE_CB_ZSTD
+		if(ra->format == read_ahead_format_zstd) {
+			ZSTD_inBuffer zin = {in, in_len, 0};
+			ZSTD_outBuffer zout = {dst, size, count};
+			size_t res = ZSTD_decompressStream(ra->zstd, &zout, &zin);
+			count = zout.pos;
+			ra->in_pos += zin.pos;
+			ra->decode_pending = (res != 0u); // 0: frame is complete
+			if(ZSTD_isError(res)) {
+				ra->decode_error = true;
+			}
+		}
+#endif
+
+		if(!has_input && count == before) {
+			ra->decode_error = true; // truncated
+			break;
+		}
+	}
+
+	return count;
+}
+
+void* read_ahead_main(void* data) {
+	struct read_ahead* ra = (struct read_ahead*) data;
+	if(!read_ahead_init_decoder(ra)) {
+		pthread_mutex_lock(&ra->mutex);
+		ra->done = true;
+		ra->error = true;
+		pthread_cond_signal(&ra->cond);
+		pthread_mutex_unlock(&ra->mutex);
+		return NULL;
+	}
+
+	unsigned i = 0u;
+	while(true) {
+		pthread_mutex_lock(&ra->mutex);
+		while(ra->filled == READ_AHEAD_BLOCKS && !ra->stop) {
+			pthread_cond_wait(&ra->cond, &ra->mutex);
+		}
+
+		bool stop = ra->stop;
+		pthread_mutex_unlock(&ra->mutex);
+		if(stop) {
+			break;
+		}
+
+		size_t count = read_ahead_decode(ra, ra->blocks[i], READ_AHEAD_BLOCK_SIZE);
+		bool end = count < READ_AHEAD_BLOCK_SIZE;
+
+		pthread_mutex_lock(&ra->mutex);
+		ra->sizes[i] = count;
+		if(count > 0) {
+			++ra->filled;
+		}
+
+		if(end) {
+			ra->done = true;
+			ra->error = ferror(ra->file) || ra->decode_error;
+		}
+
+		pthread_cond_signal(&ra->cond);
+		pthread_mutex_unlock(&ra->mutex);
+
+		if(end) {
+			break;
+		}
+
+		i = (i + 1) % READ_AHEAD_BLOCKS;
+	}
+
+	read_ahead_destroy_decoder(ra);
+	return NULL;
+}
+
+bool read_ahead_start(struct read_ahead* ra, FILE* file) {
+	ra->file = file;
+	ra->filled = 0u;
+	ra->done = false;
+	ra->error = false;
+	ra->stop = false;
+	ra->current = 0u;
+	ra->pos = 0u;
+	ra->has_block = false;
+
+	pthread_mutex_init(&ra->mutex, NULL);
+	pthread_cond_init(&ra->cond, NULL);
+	if(pthread_create(&ra->thread, NULL, read_ahead_main, ra)) {
+		pthread_cond_destroy(&ra->cond);
+		pthread_mutex_destroy(&ra->mutex);
+		return false;
+	}
+
+	return true;
+}
+
+// Can be called before everything was read, e.g. on a parse error.
+void read_ahead_stop(struct read_ahead* ra) {
+	pthread_mutex_lock(&ra->mutex);
+	ra->stop = true;
+	pthread_cond_signal(&ra->cond);
+	pthread_mutex_unlock(&ra->mutex);
+
+	pthread_join(ra->thread, NULL);
+	pthread_cond_destroy(&ra->cond);
+	pthread_mutex_destroy(&ra->mutex);
+}
+
+// Waits until the current block was read, returns false at the end.
+bool read_ahead_wait(struct read_ahead* ra) {
+	pthread_mutex_lock(&ra->mutex);
+	while(ra->filled == 0u && !ra->done) {
+		pthread_cond_wait(&ra->cond, &ra->mutex);
+	}
+
+	bool ret = ra->filled > 0u;
+	pthread_mutex_unlock(&ra->mutex);
+	return ret;
+}
+
+// Hands the current block back to the reader.
+void read_ahead_release(struct read_ahead* ra) {
+	pthread_mutex_lock(&ra->mutex);
+	--ra->filled;
+	pthread_cond_signal(&ra->cond);
+	pthread_mutex_unlock(&ra->mutex);
+
+	ra->current = (ra->current + 1) % READ_AHEAD_BLOCKS;
+	ra->pos = 0u;
+	ra->has_block = false;
+}
+
+// fgets-like read_func, assembles the lines from the blocks.
+// Lines may straddle block boundaries.
+char* parser_read_ahead(struct parser* parser) {
+	struct read_ahead* ra = (struct read_ahead*) parser->stream;
+	size_t writable = sizeof(parser->line_buf) - 1;
+	size_t len = 0u;
+	while(len < writable) {
+		if(!ra->has_block) {
+			if(!read_ahead_wait(ra)) {
+				break;
+			}
+
+			ra->has_block = true;
+		}
+
+		const char* src = ra->blocks[ra->current] + ra->pos;
+		size_t avail = ra->sizes[ra->current] - ra->pos;
+		size_t max = avail < writable - len ? avail : writable - len;
+		const char* nl = (const char*) memchr(src, '\n', max);
+		size_t count = nl ? (size_t) (1 + nl - src) : max;
+		memcpy(parser->line_buf + len, src, count);
+		len += count;
+		ra->pos += count;
+
+		if(ra->pos == ra->sizes[ra->current]) {
+			read_ahead_release(ra);
+		}
+
+		if(nl) {
+			break;
+		}
+	}
+
+	if(len == 0u) {
+		return NULL;
+	}
+
+	parser->line_buf[len] = '\0';
+	return parser->line_buf;
+}
+#endif // PARSE_CB_NO_READ_AHEAD
+
+void parser_count_depth(struct parser* parser) {
+	struct parse_stats* stats = parser->stats;
+	if(stats && parser->location.nest_depth > stats->max_depth) {
+		stats->max_depth = parser->location.nest_depth;
+	}
+}
+
+void parser_reset_batch(struct parse_batch* b) {
+	b->count = 0u;
+	b->data_len = 0u;
+	b->nest = NULL;
+}
+
+// Whether the batch has room for the events of at least one line.
+bool parser_batch_valid(const struct parse_batch* b) {
+	return b->capacity > 0 && b->data_size >= MAX_LINE_SIZE + MAX_NEST_SIZE;
+}
+
+void parser_flush_batch(struct parser* parser) {
+	struct parse_batch* b = parser->batch;
+	if(b->count > 0) {
+		b->cb(parser, b->events, b->count);
+	}
+
+	parser_reset_batch(b);
+}
+
+// Must be called when nest_buf changes.
+void parser_nest_changed(struct parser* parser) {
+	if(parser->batch) {
+		parser->batch->nest = NULL;
+	}
+}
+
+// Passes a value to the callback or adds it to the batch.
+void parser_emit(struct parser* parser, const char* name, const char* value) {
+	struct parse_batch* b = parser->batch;
+	if(!b) {
+		parser->cb(parser, name, value);
+		return;
+	}
+
+	size_t name_size = name ? strlen(name) + 1 : 0u;
+	size_t value_size = strlen(value) + 1;
+	size_t nest_size = b->nest ? 0u : parser->nest_len + 1;
+	size_t needed = name_size + value_size + nest_size;
+	if(b->count == b->capacity || b->data_len + needed > b->data_size) {
+		parser_flush_batch(parser);
+		nest_size = parser->nest_len + 1;
+		needed = name_size + value_size + nest_size;
+		assert(needed <= b->data_size); // see parser_batch_valid
+	}
+
+	if(!b->nest) {
+		char* nest = b->data + b->data_len;
+		memcpy(nest, parser->nest_buf, nest_size);
+		b->data_len += nest_size;
+		b->nest = nest;
+	}
+
+	struct parse_event* ev = &b->events[b->count++];
+	ev->name = NULL;
+	if(name) {
+		char* dst = b->data + b->data_len;
+		memcpy(dst, name, name_size);
+		b->data_len += name_size;
+		ev->name = dst;
+	}
+
+	char* dst = b->data + b->data_len;
+	memcpy(dst, value, value_size);
+	b->data_len += value_size;
+	ev->value = dst;
+
+	ev->nest = b->nest;
+	ev->nest_len = parser->nest_len;
+	ev->line = parser->location.line;
+}
+
+enum path_match {
+	path_match_none, // path can't match any projected path
+	path_match_ancestor, // path is a prefix of a projected path
+	path_match_inside, // path is equal to or inside a projected path
+};
+
+// Matches the path given by parser->nest_buf and 'name' (optional,
+// might be NULL) against the projected paths.
+enum path_match parser_match_projection(struct parser* parser, const char* name) {
+	enum path_match res = path_match_none;
+	unsigned nest_len = parser->nest_len;
+	size_t sep = (name && nest_len) ? 1 : 0;
+	size_t name_len = name ? strlen(name) : 0;
+	size_t total = nest_len + sep + name_len;
+
+	for(unsigned i = 0u; i < parser->n_projection; ++i) {
+		const char* proj = parser->projection[i];
+		size_t proj_len = strlen(proj);
+		size_t n = proj_len < total ? proj_len : total;
+
+		// compare the common prefix, piece by piece
+		size_t n1 = n < nest_len ? n : nest_len;
+		if(memcmp(parser->nest_buf, proj, n1)) {
+			continue;
+		}
+
+		if(sep && n > nest_len && proj[nest_len] != NEST_SEP[0]) {
+			continue;
+		}
+
+		size_t off = nest_len + sep;
+		if(n > off && memcmp(name, proj + off, n - off)) {
+			continue;
+		}
+
+		if(proj_len == 0 || proj_len == total) {
+			return path_match_inside;
+		} else if(proj_len < total) {
+			if(n < nest_len ? parser->nest_buf[n] == NEST_SEP[0] :
+					(n == nest_len || name[n - off] == NEST_SEP[0])) {
+				return path_match_inside;
+			}
+		} else if(total == 0 || proj[total] == NEST_SEP[0]) {
+			res = path_match_ancestor;
+		}
+	}
+
+	return res;
+}
+
+// Skips all lines belonging to the value at the current nesting level,
+// i.e. until a line with lower indentation is found. Only checks the
+// indentation of each line, comments and empty lines are skipped as well.
+// C version of skipIndented in common.hpp. Returns error_type_empty_table_array
+// if the value is empty, like parsing it would.
+enum error_type parser_skip_value(struct parser* parser) {
+	bool continued = false; // inside a line longer than line_buf
+	bool content = false;
+	while(parser->read(parser)) {
+		const char* line = parser->line_buf;
+		if(parser->stats) {
+			parser->stats->bytes += strlen(line);
+		}
+
+		if(!continued) {
+			unsigned indent = 0u;
+			while(line[indent] == '\t') {
+				++indent;
+			}
+
+			char c = line[indent];
+			bool blank = c == '\n' || c == '#' || c == '\0';
+			if(indent < parser->location.nest_depth && !blank) {
+				parser->line_valid = true;
+				break;
+			}
+
+			content = content || !blank;
+		}
+
+		continued = !strchr(line, '\n');
+		if(!continued) {
+			++parser->location.line;
+		}
+	}
+
+	parser->location.col = 0u;
+	return content ? error_type_none : error_type_empty_table_array;
+}
+
 enum error_type parse_value(struct parser* parser, char* line, int* state);
 enum error_type parse_table_or_array(struct parser* parser) {
 	int state = 0; // 0: don't know, 1: table, 2: array
 	unsigned n_items = 0u;
+	struct parse_stats* stats = parser->stats;
 	while(parser->line_valid || parser->read(parser)) {
 		char* input = parser->line_buf;
 		char* start = input;
+		if(stats && !parser->line_valid) {
+			stats->bytes += strlen(input);
+		}
+
 		parser->line_valid = false;
 		while(start[0] != '\0' && start[0] == '\t') {
 			++start;
@@ -124,6 +731,10 @@ enum error_type parse_table_or_array(struct parser* parser) {
 				break;
 			}
 
+			if(stats) {
+				++stats->comment_lines;
+			}
+
 			++parser->location.line;
 			parser->location.col = 0u;
 			continue;
@@ -132,6 +743,10 @@ enum error_type parse_table_or_array(struct parser* parser) {
 		// empty lines are also always allowd
 		if(start[0] == '\n') {
 			assert(start[1] == '\0');
+			if(stats) {
+				++stats->blank_lines;
+			}
+
 			++parser->location.line;
 			parser->location.col = 0u;
 			continue;
@@ -165,6 +780,7 @@ enum error_type parse_table_or_array(struct parser* parser) {
 			parser->location.col = 0u;
 			++parser->location.line;
 			++parser->location.nest_depth;
+			parser_count_depth(parser);
 
 			unsigned prev_len = parser->nest_len;
 			size_t bufsz = sizeof(parser->nest_buf) - parser->nest_len;
@@ -177,9 +793,17 @@ enum error_type parse_table_or_array(struct parser* parser) {
 			}
 
 			parser->nest_len += count;
+			parser_nest_changed(parser);
 
 			state = 2;
-			enum error_type err = parse_table_or_array(parser);
+			enum error_type err;
+			if(parser->n_projection && parser_match_projection(parser, NULL) ==
+					path_match_none) {
+				err = parser_skip_value(parser);
+			} else {
+				err = parse_table_or_array(parser);
+			}
+
 			if(err != error_type_none) {
 				return err;
 			}
@@ -187,6 +811,7 @@ enum error_type parse_table_or_array(struct parser* parser) {
 			--parser->location.nest_depth;
 			parser->nest_len = prev_len;
 			parser->nest_buf[parser->nest_len] = '\0';
+			parser_nest_changed(parser);
 		} else {
 			enum error_type err = parse_value(parser, start, &state);
 			if(err != error_type_none) {
@@ -197,6 +822,15 @@ enum error_type parse_table_or_array(struct parser* parser) {
 		++n_items;
 	}
 
+	if(stats && state != 0) {
+		stats->entries += n_items;
+		if(state == 1) {
+			++stats->tables;
+		} else {
+			++stats->arrays;
+		}
+	}
+
 	return (state == 0) ? error_type_empty_table_array : error_type_none;
 }
 
@@ -228,7 +862,11 @@ enum error_type parse_value(struct parser* parser, char* line, int* state) {
 			*nl = '\0';
 		}
 
-		parser->cb(parser, NULL, line);
+		if(!parser->n_projection || parser_match_projection(parser, NULL) ==
+				path_match_inside) {
+			parser_emit(parser, NULL, line);
+		}
+
 		parser->location = after_loc;
 		return error_type_none;
 	}
@@ -273,7 +911,11 @@ enum error_type parse_value(struct parser* parser, char* line, int* state) {
 			*nl = '\0';
 		}
 
-		parser->cb(parser, name, value);
+		if(!parser->n_projection || parser_match_projection(parser, name) ==
+				path_match_inside) {
+			parser_emit(parser, name, value);
+		}
+
 		parser->location = after_loc;
 		return error_type_none;
 	}
@@ -299,6 +941,7 @@ enum error_type parse_value(struct parser* parser, char* line, int* state) {
 	}
 
 	parser->nest_len += count;
+	parser_nest_changed(parser);
 
 	/*
 	unsigned prev_len = parser->nest_len;
@@ -321,12 +964,21 @@ enum error_type parse_value(struct parser* parser, char* line, int* state) {
 	parser->nest_buf[parser->nest_len] = '\0';
 	*/
 	++parser->location.nest_depth;
+	parser_count_depth(parser);
+
+	enum error_type res = error_type_none;
+	if(parser->n_projection && parser_match_projection(parser, NULL) ==
+			path_match_none) {
+		res = parser_skip_value(parser);
+	} else {
+		res = parse_table_or_array(parser);
+	}
 
-	enum error_type res = parse_table_or_array(parser);
 	if(res == error_type_none) {
 		--parser->location.nest_depth;
 		parser->nest_len = prev_len;
 		parser->nest_buf[parser->nest_len] = '\0';
+		parser_nest_changed(parser);
 	}
 
 	return res;
@@ -362,3 +1014,107 @@ struct parse_result parse_file(const char* filename, parse_func func, void* user
 	fclose((FILE*) res.parser.stream);
 	return res;
 }
+
+struct parse_result parse_file_projected(const char* filename,
+		const char* const* projection, unsigned n_projection,
+		parse_func func, void* user) {
+	struct parse_result res = {};
+	res.parser.stream = fopen(filename, "r");
+	res.parser.read = parser_read_fgets;
+	res.parser.cb = func;
+	res.parser.user = user;
+	res.parser.projection = projection;
+	res.parser.n_projection = n_projection;
+	res.error = parse_table_or_array(&res.parser);
+	fclose((FILE*) res.parser.stream);
+	return res;
+}
+
+struct parse_result parse_file_batched(const char* filename,
+		struct parse_batch* batch, void* user) {
+	struct parse_result res = {};
+	if(!parser_batch_valid(batch)) {
+		res.error = error_type_invalid_batch;
+		return res;
+	}
+
+	res.parser.stream = fopen(filename, "r");
+	res.parser.read = parser_read_fgets;
+	res.parser.batch = batch;
+	parser_reset_batch(batch);
+	res.parser.user = user;
+	res.error = parse_table_or_array(&res.parser);
+	parser_flush_batch(&res.parser);
+	fclose((FILE*) res.parser.stream);
+	return res;
+}
+
+struct parse_result parse_string_batched(const char* str,
+		struct parse_batch* batch, void* user) {
+	struct parse_result res = {};
+	if(!parser_batch_valid(batch)) {
+		res.error = error_type_invalid_batch;
+		return res;
+	}
+
+	res.parser.stream = (void*) str;
+	res.parser.read = parser_read_mem;
+	res.parser.batch = batch;
+	parser_reset_batch(batch);
+	res.parser.user = user;
+	res.error = parse_table_or_array(&res.parser);
+	parser_flush_batch(&res.parser);
+	return res;
+}
+
+#ifndef PARSE_CB_NO_READ_AHEAD
+struct parse_result parse_file_read_ahead(const char* filename,
+		parse_func func, void* user) {
+	struct parse_result res = {};
+	FILE* file = fopen(filename, "rb");
+	if(!file) {
+		res.error = error_type_read_failed;
+		return res;
+	}
+
+	// too large for the stack, the only allocation
+	struct read_ahead* ra = (struct read_ahead*) malloc(sizeof(*ra));
+	if(!ra || !read_ahead_start(ra, file)) {
+		// fall back to reading synchronously, compressed files
+		// can only be decoded by the read-ahead
+		free(ra);
+		unsigned char magic[4];
+		size_t magic_len = fread(magic, 1, sizeof(magic), file);
+		if(read_ahead_detect(magic, magic_len) != read_ahead_format_raw ||
+				fseek(file, 0, SEEK_SET)) {
+			res.error = error_type_read_failed;
+			fclose(file);
+			return res;
+		}
+
+		res.parser.stream = file;
+		res.parser.read = parser_read_fgets;
+		res.parser.cb = func;
+		res.parser.user = user;
+		res.error = parse_table_or_array(&res.parser);
+		fclose(file);
+		return res;
+	}
+
+	res.parser.stream = ra;
+	res.parser.read = parser_read_ahead;
+	res.parser.cb = func;
+	res.parser.user = user;
+	res.error = parse_table_or_array(&res.parser);
+
+	read_ahead_stop(ra);
+	if(ra->error) {
+		res.error = error_type_read_failed;
+	}
+
+	free(ra);
+	fclose(file);
+	res.parser.stream = NULL;
+	return res;
+}
+#endif // PARSE_CB_NO_READ_AHEAD
@@ -0,0 +1,331 @@
+#pragma once
+
+// Persistent (immutable, structurally shared) variant of the Value model
+// of data.hpp. Copying a PValue only copies a reference-counted pointer,
+// modifications return a new PValue that shares all unmodified subtrees
+// with the old one (path copying): only the vectors and tables along the
+// modified path are copied, each one level deep. An update therefore
+// costs O(depth * width), with the number of entries of the tables
+// along the path as width: every entry (a key and a reference-counted
+// pointer) of them is copied, their subtrees are not. Old versions stay
+// valid and unchanged, so keeping several snapshots of a document
+// (current, pending, rollback) is cheap. Since nodes are never modified,
+// snapshots can be read concurrently from multiple threads.
+// See s2/persistent.hpp for the s2 variant.
+//
+// Paths are dotted table keys and vector indices, e.g. "mie.rgb.2".
+// Tables are stored as vectors sorted by key, lookups are binary
+// searches and copying them along a path is a single allocation.
+
+#include "data.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
+#include <vector>
+
+class PValue {
+public:
+	using Entry = std::pair<std::string, PValue>;
+
+	PValue() = default; // empty string
+	PValue(std::string str) : node_(std::make_shared<const Node>(std::move(str))) {}
+
+	static PValue vector(std::vector<PValue> items) {
+		PValue ret;
+		ret.node_ = std::make_shared<const Node>(std::move(items));
+		return ret;
+	}
+
+	// Entries with duplicate keys are removed, the first one is kept.
+	static PValue table(std::vector<Entry> entries) {
+		auto less = [](const Entry& a, const Entry& b) { return a.first < b.first; };
+		auto equal = [](const Entry& a, const Entry& b) { return a.first == b.first; };
+		std::stable_sort(entries.begin(), entries.end(), less);
+		entries.erase(std::unique(entries.begin(), entries.end(), equal), entries.end());
+
+		PValue ret;
+		ret.node_ = std::make_shared<const Node>(std::move(entries));
+		return ret;
+	}
+
+	// Return nullptr if the value is of another type.
+	const std::string* asString() const;
+	const std::vector<PValue>* asVector() const;
+	const std::vector<Entry>* asTable() const; // sorted by key
+
+	// Whether both share the same node, i.e. are (cheaply) known
+	// to be equal.
+	bool sameAs(const PValue& other) const { return node_ == other.node_; }
+
+	// Returns the value of the given key if this is a table.
+	const PValue* find(std::string_view key) const;
+
+	// Returns the value at the given path, nullptr if there is none.
+	const PValue* at(std::string_view path) const;
+
+	// Returns a copy in which the value at 'path' is 'value'.
+	// Missing keys along the path are inserted, strings along the
+	// path replaced by tables. An index equal to the size of the vector
+	// appends a new item. Returns the value itself if an index along the
+	// path is invalid (not a number or larger than the size).
+	PValue set(std::string_view path, PValue value) const;
+
+	// Returns a copy without the value at 'path'.
+	// Returns the value itself if there is no such value.
+	PValue remove(std::string_view path) const;
+
+private:
+	using Node = std::variant<std::string, std::vector<PValue>, std::vector<Entry>>;
+	std::shared_ptr<const Node> node_; // nullptr for the empty string
+
+	std::size_t lowerBound(std::string_view key) const {
+		auto& entries = std::get<std::vector<Entry>>(*node_);
+		auto it = std::lower_bound(entries.begin(), entries.end(), key,
+			[](const Entry& e, std::string_view k) { return e.first < k; });
+		return it - entries.begin();
+	}
+};
+
+namespace detail {
+
+inline std::pair<std::string_view, std::string_view> splitPath(std::string_view path) {
+	auto dot = path.find('.');
+	if(dot == path.npos) {
+		return {path, {}};
+	}
+
+	return {path.substr(0, dot), path.substr(dot + 1)};
+}
+
+inline std::optional<std::size_t> parsePathIndex(std::string_view seg) {
+	auto str = std::string(seg);
+	char* end {};
+	auto i = std::strtoull(str.c_str(), &end, 10);
+	if(str.empty() || end != str.c_str() + str.size()) {
+		return std::nullopt;
+	}
+
+	return i;
+}
+
+} // namespace detail
+
+inline const std::string* PValue::asString() const {
+	static const std::string empty;
+	return node_ ? std::get_if<std::string>(node_.get()) : &empty;
+}
+
+inline const std::vector<PValue>* PValue::asVector() const {
+	return node_ ? std::get_if<std::vector<PValue>>(node_.get()) : nullptr;
+}
+
+inline const std::vector<PValue::Entry>* PValue::asTable() const {
+	return node_ ? std::get_if<std::vector<Entry>>(node_.get()) : nullptr;
+}
+
+inline const PValue* PValue::find(std::string_view key) const {
+	auto* entries = asTable();
+	if(!entries) {
+		return nullptr;
+	}
+
+	auto i = lowerBound(key);
+	if(i == entries->size() || (*entries)[i].first != key) {
+		return nullptr;
+	}
+
+	return &(*entries)[i].second;
+}
+
+inline const PValue* PValue::at(std::string_view path) const {
+	auto* value = this;
+	while(value && !path.empty()) {
+		auto [seg, rest] = detail::splitPath(path);
+		path = rest;
+		if(auto* items = value->asVector()) {
+			auto i = detail::parsePathIndex(seg);
+			value = (i && *i < items->size()) ? &(*items)[*i] : nullptr;
+		} else {
+			value = value->find(seg);
+		}
+	}
+
+	return value;
+}
+
+inline PValue PValue::set(std::string_view path, PValue value) const {
+	if(path.empty()) {
+		return value;
+	}
+
+	auto [seg, rest] = detail::splitPath(path);
+	if(auto* items = asVector()) {
+		auto i = detail::parsePathIndex(seg);
+		if(!i || *i > items->size()) {
+			return *this;
+		}
+
+		auto child = *i < items->size() ? (*items)[*i] : PValue{};
+		auto updated = child.set(rest, std::move(value));
+		if(*i < items->size() && updated.sameAs(child)) {
+			return *this; // invalid index further down the path
+		}
+
+		auto copy = *items;
+		if(*i == copy.size()) {
+			copy.push_back(std::move(updated));
+		} else {
+			copy[*i] = std::move(updated);
+		}
+
+		return vector(std::move(copy));
+	}
+
+	auto* entries = asTable();
+	auto i = entries ? lowerBound(seg) : 0u;
+	auto found = entries && i < entries->size() && (*entries)[i].first == seg;
+	auto child = found ? (*entries)[i].second : PValue{};
+	auto updated = child.set(rest, std::move(value));
+	if(found && updated.sameAs(child)) {
+		return *this;
+	}
+
+	auto copy = entries ? *entries : std::vector<Entry>{};
+	if(!found) {
+		copy.insert(copy.begin() + i, {std::string(seg), std::move(updated)});
+	} else {
+		copy[i].second = std::move(updated);
+	}
+
+	PValue ret;
+	ret.node_ = std::make_shared<const Node>(std::move(copy));
+	return ret;
+}
+
+inline PValue PValue::remove(std::string_view path) const {
+	if(path.empty()) {
+		return *this;
+	}
+
+	auto [seg, rest] = detail::splitPath(path);
+	auto update = [&](PValue& child) {
+		auto removed = child.remove(rest);
+		if(removed.sameAs(child)) {
+			return false;
+		}
+
+		child = std::move(removed);
+		return true;
+	};
+
+	if(auto* items = asVector()) {
+		auto i = detail::parsePathIndex(seg);
+		if(!i || *i >= items->size()) {
+			return *this;
+		}
+
+		auto copy = *items;
+		if(rest.empty()) {
+			copy.erase(copy.begin() + *i);
+		} else if(!update(copy[*i])) {
+			return *this;
+		}
+
+		return vector(std::move(copy));
+	}
+
+	auto* entries = asTable();
+	if(!entries) {
+		return *this;
+	}
+
+	auto i = lowerBound(seg);
+	if(i == entries->size() || (*entries)[i].first != seg) {
+		return *this;
+	}
+
+	auto copy = *entries;
+	if(rest.empty()) {
+		copy.erase(copy.begin() + i);
+	} else if(!update(copy[i].second)) {
+		return *this;
+	}
+
+	PValue ret;
+	ret.node_ = std::make_shared<const Node>(std::move(copy));
+	return ret;
+}
+
+// Conversions from and to the mutable representation.
+inline PValue makePersistent(const Value& value) {
+	if(auto* str = std::get_if<std::string>(&value.value)) {
+		return PValue(*str);
+	}
+
+	if(auto* vec = std::get_if<Vector>(&value.value)) {
+		std::vector<PValue> items;
+		items.reserve(vec->size());
+		for(auto& item : *vec) {
+			items.push_back(makePersistent(*item));
+		}
+
+		return PValue::vector(std::move(items));
+	}
+
+	// numeric arrays become vectors of strings
+	auto numbers = [](const auto& nums, auto&& toString) {
+		std::vector<PValue> items;
+		items.reserve(nums.size());
+		for(auto n : nums) {
+			items.push_back(PValue(toString(n)));
+		}
+
+		return PValue::vector(std::move(items));
+	};
+
+	if(auto* ints = std::get_if<Integers>(&value.value)) {
+		return numbers(*ints, [](auto i) { return std::to_string(i); });
+	}
+
+	if(auto* nums = std::get_if<Numbers>(&value.value)) {
+		return numbers(*nums, numberString);
+	}
+
+	auto& table = std::get<Table>(value.value);
+	std::vector<PValue::Entry> entries;
+	entries.reserve(table.size());
+	for(auto& [key, item] : table) {
+		entries.push_back({key, makePersistent(*item)});
+	}
+
+	return PValue::table(std::move(entries));
+}
+
+inline Value toValue(const PValue& value) {
+	if(auto* items = value.asVector()) {
+		Vector vec;
+		vec.reserve(items->size());
+		for(auto& item : *items) {
+			vec.push_back(std::make_unique<Value>(toValue(item)));
+		}
+
+		return {std::move(vec)};
+	}
+
+	if(auto* entries = value.asTable()) {
+		Table table;
+		table.reserve(entries->size());
+		for(auto& [key, item] : *entries) {
+			table.emplace(key, std::make_unique<Value>(toValue(item)));
+		}
+
+		return {std::move(table)};
+	}
+
+	return {*value.asString()};
+}
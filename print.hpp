@@ -1,13 +1,52 @@
 #pragma once
 
+#include "blob.hpp"
 #include "common.hpp"
 #include "data.hpp"
+#include "stats.hpp"
+
+// Prints the items of Integers or Numbers like a vector of strings,
+// or as a single blob (see blob.hpp).
+template<typename C, typename F>
+std::string printNumbers(const C& numbers, unsigned indent, bool inArray,
+		bool blob, F&& toString) {
+	std::string cat;
+	if(inArray) {
+		cat += "-";
+		++indent;
+	}
+
+	auto sep = indent > 0 ? "\n" : "";
+	if(blob) {
+		cat += sep;
+		cat.append(indent, '\t');
+		printBlob(cat, numbers.data(), numbers.size());
+		return cat;
+	}
+
+	for(auto number : numbers) {
+		cat += sep;
+		cat.append(indent, '\t');
+		cat += toString(number);
+		sep = "\n";
+	}
+
+	return cat;
+}
+
+// Works for Value and pmr::Value. With 'blobs', numeric arrays are
+// printed as blobs.
+template<typename V>
+std::string printValue(const V& val, unsigned indent, bool inArray, bool blobs = false) {
+	using Variant = decltype(val.value);
+	using String = std::variant_alternative_t<0, Variant>;
+	using VectorT = std::variant_alternative_t<1, Variant>;
+	using TableT = std::variant_alternative_t<2, Variant>;
 
-std::string print(const Value& val, unsigned indent = 0u, bool inArray = false) {
 	return std::visit(Visitor{
-		[](const std::string& sv) {
-			return sv;
-		}, [&](const Table& table) {
+		[](const String& sv) {
+			return std::string(sv);
+		}, [&](const TableT& table) {
 			std::string cat;
 			if(inArray) {
 				cat += "-";
@@ -18,15 +57,15 @@ std::string print(const Value& val, unsigned indent = 0u, bool inArray = false)
 			for(auto& val : table) {
 				std::string str(indent, '\t');
 				str = sep + str;
-				str += val.first;
+				str += std::string_view(val.first);
 				str += ": ";
-				str += print(*val.second, indent + 1);
+				str += printValue(*val.second, indent + 1, false, blobs);
 				cat += str;
 				sep = "\n";
 			}
 
 			return cat;
-		}, [&](const Vector& vec) {
+		}, [&](const VectorT& vec) {
 			std::string cat;
 			if(inArray) {
 				cat += "-";
@@ -37,13 +76,33 @@ std::string print(const Value& val, unsigned indent = 0u, bool inArray = false)
 			for(auto& val : vec) {
 				std::string str(indent, '\t');
 				str = sep + str;
-				str += print(*val, indent + 1, true);
+				str += printValue(*val, indent, true, blobs);
 				cat += str;
 				sep = "\n";
 			}
 			return cat;
 
+		}, [&](const Integers& ints) {
+			return printNumbers(ints, indent, inArray, blobs, [](auto i) { return std::to_string(i); });
+		}, [&](const Numbers& nums) {
+			return printNumbers(nums, indent, inArray, blobs, numberString);
 		},
 	}, val.value);
 }
 
+std::string print(const Value& val, unsigned indent = 0u, bool inArray = false,
+		bool blobs = false) {
+	return printValue(val, indent, inArray, blobs);
+}
+
+std::string print(const pmr::Value& val, unsigned indent = 0u, bool inArray = false) {
+	return printValue(val, indent, inArray);
+}
+
+// Like above, records allocations and written bytes in 'stats'.
+std::string print(const Value& val, ParseStats& stats) {
+	StatsScope statsScope(&stats);
+	auto ret = print(val);
+	stats.bytes += ret.size();
+	return ret;
+}
@@ -0,0 +1,171 @@
+#pragma once
+
+// Lock-free publication of documents (or any other value), RCU style.
+// A reloader thread publishes new versions, reader threads take
+// snapshots without locks: a read costs two loads and one store.
+// Old versions are destroyed once no reader can still use them
+// (epoch based reclamation).
+//
+// ConfigHandle<Value> handle(std::move(initial));
+//
+// // reader thread, each one with its own Reader:
+// auto reader = handle.reader();
+// {
+// 	auto snap = reader->read();
+// 	auto* mie = at(*snap, "mie");
+// } // don't hold snapshots for long, they delay reclamation
+//
+// // reloader thread:
+// Parser parser{content};
+// auto res = parseTableOrArray(parser);
+// handle.publish(std::move(std::get<NamedValue>(res).value));
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+
+template<typename T, unsigned MaxReaders = 64>
+class ConfigHandle {
+public:
+	class Reader;
+
+	// Valid while it exists, i.e. the value isn't destroyed before
+	// the snapshot is. Only one snapshot per Reader at a time.
+	class Snapshot {
+	public:
+		Snapshot(Snapshot&& other) noexcept :
+			slot_(std::exchange(other.slot_, nullptr)), value_(other.value_) {}
+		Snapshot& operator=(Snapshot&&) = delete;
+
+		~Snapshot() {
+			if(slot_) {
+				slot_->store(0u, std::memory_order_release);
+			}
+		}
+
+		const T& operator*() const { return *value_; }
+		const T* operator->() const { return value_; }
+		const T* get() const { return value_; }
+
+	private:
+		friend class Reader;
+		Snapshot(std::atomic<std::uint64_t>* slot, const T* value) :
+			slot_(slot), value_(value) {}
+
+		std::atomic<std::uint64_t>* slot_;
+		const T* value_;
+	};
+
+	// Per reader thread, owns one of the MaxReaders slots.
+	class Reader {
+	public:
+		Reader(Reader&& other) noexcept :
+			handle_(std::exchange(other.handle_, nullptr)), slot_(other.slot_) {}
+		Reader& operator=(Reader&&) = delete;
+
+		~Reader() {
+			if(handle_) {
+				handle_->slots_[slot_].used.store(false, std::memory_order_release);
+			}
+		}
+
+		Snapshot read() const {
+			auto& epoch = handle_->slots_[slot_].epoch;
+			assert(epoch.load(std::memory_order_relaxed) == 0u);
+
+			// announcing the epoch must be ordered before loading the
+			// pointer, otherwise a writer might miss us, hence seq_cst.
+			epoch.store(handle_->epoch_.load());
+			return {&epoch, handle_->current_.load()};
+		}
+
+	private:
+		friend class ConfigHandle;
+		Reader(ConfigHandle* handle, unsigned slot) : handle_(handle), slot_(slot) {}
+
+		ConfigHandle* handle_;
+		unsigned slot_;
+	};
+
+	explicit ConfigHandle(T initial) : current_(new T(std::move(initial))) {}
+
+	ConfigHandle(const ConfigHandle&) = delete;
+	ConfigHandle& operator=(const ConfigHandle&) = delete;
+
+	// All readers and snapshots must have been destroyed.
+	~ConfigHandle() {
+		delete current_.load();
+	}
+
+	// Returns nullopt if all MaxReaders slots are taken.
+	std::optional<Reader> reader() {
+		for(auto i = 0u; i < MaxReaders; ++i) {
+			auto expected = false;
+			if(slots_[i].used.compare_exchange_strong(expected, true,
+					std::memory_order_acquire)) {
+				return Reader(this, i);
+			}
+		}
+
+		return std::nullopt;
+	}
+
+	// Replaces the current value. Readers see the new one from their
+	// next snapshot on. Reclaims old versions that aren't used anymore.
+	// Can be called from multiple threads.
+	void publish(T value) {
+		auto next = std::make_unique<T>(std::move(value));
+		auto* old = current_.exchange(next.release());
+		auto epoch = epoch_.fetch_add(1u);
+
+		std::lock_guard lock(retiredMutex_);
+		retired_.push_back({epoch, std::unique_ptr<T>(old)});
+		reclaimLocked();
+	}
+
+	// Destroys the old versions that aren't used anymore.
+	// Returns the number of old versions still alive.
+	std::size_t reclaim() {
+		std::lock_guard lock(retiredMutex_);
+		reclaimLocked();
+		return retired_.size();
+	}
+
+private:
+	struct alignas(64) Slot { // own cache line, avoid false sharing
+		std::atomic<std::uint64_t> epoch {0u}; // 0: not reading
+		std::atomic<bool> used {false};
+	};
+
+	struct Retired {
+		std::uint64_t epoch; // readers of this or earlier epochs might use it
+		std::unique_ptr<T> value;
+	};
+
+	void reclaimLocked() {
+		auto minEpoch = std::uint64_t(-1);
+		for(auto& slot : slots_) {
+			auto epoch = slot.epoch.load();
+			if(epoch != 0u && epoch < minEpoch) {
+				minEpoch = epoch;
+			}
+		}
+
+		auto end = std::remove_if(retired_.begin(), retired_.end(),
+			[&](const Retired& r) { return r.epoch < minEpoch; });
+		retired_.erase(end, retired_.end());
+	}
+
+	std::atomic<T*> current_;
+	std::atomic<std::uint64_t> epoch_ {1u};
+	Slot slots_[MaxReaders];
+
+	std::mutex retiredMutex_; // only used by writers
+	std::vector<Retired> retired_;
+};
@@ -0,0 +1,69 @@
+#pragma once
+
+// Variant of the s2 'Table' model whose table names are interned Atoms
+// instead of individually allocated strings. Arrays of records that
+// repeat the same keys only store each key once. Values (entries
+// without a table) are stored as plain strings, they rarely repeat and
+// would only fill the AtomTable.
+// Built from the callback parser, so the input isn't copied either
+// (apart from the interned strings and the values).
+
+#include "parse2.hpp"
+#include "../intern.hpp"
+#include <string>
+#include <vector>
+
+struct AEntry;
+struct ATable : std::vector<AEntry> {};
+
+struct AEntry {
+	Atom name; // empty for values
+	std::string value; // only for values
+	ATable table;
+
+	std::string_view key() const { return name ? name.view() : value; }
+};
+
+// parse2 handler building an ATable.
+struct ATableBuilder {
+	AtomTable& atoms;
+	std::vector<ATable*> nest; // not bounded, the parser isn't either
+
+	ATableBuilder(AtomTable& a, ATable& root) : atoms(a), nest{&root} {}
+
+	ATableBuilder* enterTable(Parser&, std::string_view name) {
+		auto& entry = nest.back()->emplace_back(AEntry{atoms.intern(name), {}, {}});
+		nest.push_back(&entry.table);
+		return this;
+	}
+
+	void exitTable(Parser&) {
+		nest.pop_back();
+	}
+
+	void entry(Parser&, std::string_view value) {
+		nest.back()->emplace_back(AEntry{{}, std::string(value), {}});
+	}
+};
+
+inline ATable parseATable(AtomTable& atoms, Parser& parser, Error& error) {
+	ATable ret;
+	ATableBuilder builder(atoms, ret);
+	parseTable(builder, parser, error);
+	return ret;
+}
+
+// Returns the table of the first entry with the given name, nullptr if
+// there is none. Values match by their string and have an empty table.
+// The name is looked up once, table names are then compared by id.
+inline const ATable* find(const AtomTable& atoms, const ATable& table,
+		std::string_view name) {
+	auto atom = atoms.find(name);
+	for(auto& entry : table) {
+		if(entry.name ? atom && entry.name == atom : entry.value == name) {
+			return &entry.table;
+		}
+	}
+
+	return nullptr;
+}
@@ -2,5 +2,15 @@
 
 #include <vector>
 #include <string>
+#include <memory_resource>
 
 struct Table : std::vector<std::pair<std::string, Table>> {};
+
+// Variant of Table allocating all memory from a std::pmr::memory_resource.
+namespace pmr {
+
+struct Table : std::pmr::vector<std::pair<std::pmr::string, Table>> {
+	using vector::vector;
+};
+
+} // namespace pmr
@@ -0,0 +1,197 @@
+#pragma once
+
+// Structural diff and patch for s2 tables.
+// A patch is a list of edits (insert, remove, replace) that transforms
+// one table into another. Identical subtrees are detected via their
+// fingerprints (see fingerprint.hpp) and skipped, entries are aligned
+// via ../align.hpp. This runs in O(n log n) but doesn't always find the
+// minimal patch.
+//
+// Paths are the dotted indices of the entries from the root, e.g. "2.0"
+// is the first entry of the third entry. Since entries may be inserted
+// and removed, the indices refer to the document as it is when the
+// edit is applied, i.e. after all previous edits of the patch.
+// Patches can be converted to a table (and printed/parsed as such).
+
+#include "data.hpp"
+#include "fingerprint.hpp"
+#include "../align.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+enum class EditKind {
+	insert, // insert 'entry' at 'path'
+	remove, // remove the entry at 'path'
+	replace, // replace the entry at 'path' with 'entry'
+};
+
+struct Edit {
+	EditKind kind;
+	std::string path;
+	std::pair<std::string, Table> entry {}; // for insert, replace
+};
+
+using Patch = std::vector<Edit>;
+
+namespace detail {
+
+inline std::string childPath(const std::string& path, std::size_t i) {
+	return path.empty() ? std::to_string(i) : path + "." + std::to_string(i);
+}
+
+inline void diff(const Table& a, const HashTree& ha,
+		const Table& b, const HashTree& hb,
+		const std::string& path, Patch& out) {
+	// edits are emitted from back to front, so that the indices of
+	// the earlier entries stay valid.
+	auto steps = align(a.size(), [&](std::size_t i) { return ha.children[i].entry; },
+		b.size(), [&](std::size_t j) { return hb.children[j].entry; });
+
+	for(auto s = steps.size(); s-- > 0u;) {
+		auto& step = steps[s];
+		auto p = childPath(path, step.ai);
+		switch(step.op) {
+			case AlignOp::pair:
+				// entries with different names are replaced as a whole
+				if(a[step.ai].first == b[step.bj].first) {
+					diff(a[step.ai].second, ha.children[step.ai],
+						b[step.bj].second, hb.children[step.bj], p, out);
+				} else {
+					out.push_back({EditKind::replace, std::move(p), b[step.bj]});
+				}
+				break;
+			case AlignOp::remove:
+				out.push_back({EditKind::remove, std::move(p)});
+				break;
+			case AlignOp::insert:
+				out.push_back({EditKind::insert, std::move(p), b[step.bj]});
+				break;
+		}
+	}
+}
+
+} // namespace detail
+
+// Returns the edits transforming 'a' into 'b'.
+inline Patch diff(const Table& a, const Table& b) {
+	Patch ret;
+	auto ha = hashTree(a);
+	auto hb = hashTree(b);
+	if(ha.table != hb.table) {
+		detail::diff(a, ha, b, hb, {}, ret);
+	}
+
+	return ret;
+}
+
+// Applies the patch in place. Returns false if an edit has an invalid
+// path. The edits before it were applied then.
+inline bool applyPatch(Table& doc, const Patch& patch) {
+	for(auto& edit : patch) {
+		auto* table = &doc;
+		std::string_view path = edit.path;
+		while(true) {
+			auto dot = path.find('.');
+			auto seg = path.substr(0, dot);
+			char* end {};
+			auto str = std::string(seg);
+			auto i = std::strtoull(str.c_str(), &end, 10);
+			if(seg.empty() || end != str.c_str() + str.size()) {
+				return false;
+			}
+
+			if(dot != path.npos) {
+				if(i >= table->size()) {
+					return false;
+				}
+
+				table = &(*table)[i].second;
+				path = path.substr(dot + 1);
+				continue;
+			}
+
+			auto limit = table->size() + (edit.kind == EditKind::insert);
+			if(i >= limit) {
+				return false;
+			}
+
+			auto it = table->begin() + i;
+			switch(edit.kind) {
+				case EditKind::insert:
+					table->insert(it, edit.entry);
+					break;
+				case EditKind::remove:
+					table->erase(it);
+					break;
+				case EditKind::replace:
+					*it = edit.entry;
+					break;
+			}
+
+			break;
+		}
+	}
+
+	return true;
+}
+
+// Patch as table, e.g. for printing:
+// insert:
+// 	1.2
+// 	name: value
+// remove: 3
+inline Table toTable(const Patch& patch) {
+	Table ret;
+	for(auto& edit : patch) {
+		auto& entry = ret.emplace_back();
+		switch(edit.kind) {
+			case EditKind::insert: entry.first = "insert"; break;
+			case EditKind::remove: entry.first = "remove"; break;
+			case EditKind::replace: entry.first = "replace"; break;
+		}
+
+		entry.second.push_back({edit.path, {}});
+		if(edit.kind != EditKind::remove) {
+			entry.second.push_back(edit.entry);
+		}
+	}
+
+	return ret;
+}
+
+// Inverse of toTable. Returns nullopt if 'table' is not a valid patch.
+inline std::optional<Patch> fromTable(const Table& table) {
+	Patch ret;
+	for(auto& [name, content] : table) {
+		Edit edit;
+		if(name == "insert") {
+			edit.kind = EditKind::insert;
+		} else if(name == "remove") {
+			edit.kind = EditKind::remove;
+		} else if(name == "replace") {
+			edit.kind = EditKind::replace;
+		} else {
+			return std::nullopt;
+		}
+
+		auto size = (edit.kind == EditKind::remove) ? 1u : 2u;
+		if(content.size() != size || !content[0].second.empty()) {
+			return std::nullopt;
+		}
+
+		edit.path = content[0].first;
+		if(size == 2u) {
+			edit.entry = content[1];
+		}
+
+		ret.push_back(std::move(edit));
+	}
+
+	return ret;
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+// Fingerprints (128-bit content hashes, see ../hash.hpp) of s2 tables.
+// They are order-sensitive, like the tables: two tables have the same
+// fingerprint if (and, up to collisions, only if) they are equal.
+//
+// Works with both s2/parse.hpp and s2/parse2.hpp. TableHasher computes
+// the fingerprint while parsing with parse2.hpp, without building a
+// table. Since parse2.hpp doesn't resolve escapes, this only matches the
+// fingerprint of the parsed table for documents without them.
+
+#include "data.hpp"
+#include "../hash.hpp"
+#include <string_view>
+#include <vector>
+
+// Seed of every table, so that empty tables don't hash to zero.
+constexpr auto tableFingerprintSeed = Fingerprint{0x8f1bbcdc5a827999u, 0x6ed9eba1ca62c1d6u};
+
+// Fingerprint of an entry, given the fingerprint of its table.
+inline Fingerprint entryFingerprint(std::string_view name, Fingerprint table) {
+	return hashCombine(hashString(name), table);
+}
+
+inline Fingerprint fingerprint(const Table& table) {
+	auto ret = tableFingerprintSeed;
+	for(auto& [name, child] : table) {
+		ret = hashCombine(ret, entryFingerprint(name, fingerprint(child)));
+	}
+
+	return hashCombine(ret, table.size());
+}
+
+// Tree of fingerprints parallel to a table. Computed once, it answers
+// equality checks for every subtree in O(1). Must be computed again
+// when the table is modified.
+struct HashTree {
+	Fingerprint entry {}; // name and table, see entryFingerprint
+	Fingerprint table {}; // see fingerprint(Table)
+	std::vector<HashTree> children;
+};
+
+inline HashTree hashTree(std::string_view name, const Table& table) {
+	HashTree ret;
+	ret.table = tableFingerprintSeed;
+	ret.children.reserve(table.size());
+	for(auto& [cname, child] : table) {
+		auto& ct = ret.children.emplace_back(hashTree(cname, child));
+		ret.table = hashCombine(ret.table, ct.entry);
+	}
+
+	ret.table = hashCombine(ret.table, table.size());
+	ret.entry = entryFingerprint(name, ret.table);
+	return ret;
+}
+
+inline HashTree hashTree(const Table& table) {
+	return hashTree({}, table);
+}
+
+// parse2 handler computing the fingerprint of the parsed document:
+// TableHasher hasher;
+// parseTable(hasher, parser, error);
+// auto fp = hasher.result();
+struct TableHasher {
+	struct Level {
+		Fingerprint table {tableFingerprintSeed};
+		std::uint64_t count {};
+		std::string_view name {};
+	};
+
+	// Grows with the nesting, which the parser doesn't bound either.
+	std::vector<Level> nest {Level{}};
+
+	template<typename P>
+	TableHasher* enterTable(P&, std::string_view name) {
+		nest.push_back({tableFingerprintSeed, 0u, name});
+		return this;
+	}
+
+	template<typename P>
+	void exitTable(P&) {
+		auto& level = nest.back();
+		auto entry = entryFingerprint(level.name,
+			hashCombine(level.table, level.count));
+		nest.pop_back();
+		add(entry);
+	}
+
+	template<typename P>
+	void entry(P&, std::string_view value) {
+		add(entryFingerprint(value, hashCombine(tableFingerprintSeed, 0u)));
+	}
+
+	void add(Fingerprint entry) {
+		auto& level = nest.back();
+		level.table = hashCombine(level.table, entry);
+		++level.count;
+	}
+
+	// Fingerprint of the whole document, once parsed.
+	// Meaningless if parsing failed.
+	Fingerprint result() const {
+		return hashCombine(nest[0].table, nest[0].count);
+	}
+};
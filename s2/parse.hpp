@@ -1,10 +1,15 @@
 #pragma once
 
 #include "data.hpp"
+#include "../common.hpp"
+#include "../stats.hpp"
 #include <vector>
 #include <string>
 #include <string_view>
+#include <type_traits>
 #include <cassert>
+#include <cstdint>
+#include <cstring>
 #include <cstdio> // TODO: remove
 
 struct Location {
@@ -16,6 +21,16 @@ struct Location {
 struct Parser {
 	std::string_view input;
 	Location location {};
+
+	// Dotted paths (e.g. "mie.scattering") of the subtrees to parse.
+	// Tables that can't lie on or inside any of them are skipped
+	// without being tokenized. Empty: parse everything.
+	std::vector<std::string_view> projection {};
+
+	ParseStats* stats {}; // optional
+
+	// Where pmr::Tables are allocated from. Default resource if null.
+	std::pmr::memory_resource* memory {};
 };
 
 enum class ErrorType {
@@ -31,71 +46,162 @@ struct Error {
 	std::string_view data {}; // dependent on 'type'
 };
 
-Table parseTable(Parser&, Error& error);
+// The data model is chosen via 'T', either Table or pmr::Table.
+template<typename T = Table> T parseTable(Parser&, Error& error);
 
-inline std::string parseString(Parser& parser, Error& error) {
+// Creates an empty table of the data model T.
+template<typename T>
+T makeTable(const Parser& parser) {
+	if constexpr(std::is_same_v<T, Table>) {
+		return {};
+	} else {
+		return T(parser.memory ? parser.memory : std::pmr::get_default_resource());
+	}
+}
+
+// Creates a string of the data model T.
+template<typename T>
+auto makeString(const Parser& parser, std::string_view str) {
+	using String = typename T::value_type::first_type;
+	if constexpr(std::is_same_v<T, Table>) {
+		return String(str);
+	} else {
+		return String(str, parser.memory ? parser.memory :
+			std::pmr::get_default_resource());
+	}
+}
+
+// Matches the path given by the parsers current nesting and 'name'
+// against the projected paths.
+inline PathMatch matchProjection(const Parser& parser, std::string_view name) {
+	auto& nest = parser.location.nest;
+	return matchPaths(parser.projection.data(), parser.projection.size(),
+		nest.data(), nest.size(), &name);
+}
+
+// Skips all lines belonging to the table at the current nesting
+// level, see skipIndented.
+inline void skipTable(Parser& parser) {
+	skipIndented(parser.input, parser.location.nest.size(),
+		parser.location.line, parser.location.col);
+}
+
+// Returns the position of the next '\\', ':' or '\n' in 'str' at or
+// after 'pos', or str.size() if there is none.
+// Checks 8 bytes at once, using the usual 'has zero byte' trick.
+inline std::size_t findSpecial(std::string_view str, std::size_t pos) {
+	constexpr auto ones = std::uint64_t(0x0101010101010101ull);
+	constexpr auto highs = std::uint64_t(0x8080808080808080ull);
+	auto hasZero = [](std::uint64_t v) {
+		return (v - ones) & ~v & highs;
+	};
+
+	for(; pos + 8 <= str.size(); pos += 8) {
+		std::uint64_t v;
+		std::memcpy(&v, str.data() + pos, 8);
+		if(hasZero(v ^ (ones * '\\')) | hasZero(v ^ (ones * ':')) |
+				hasZero(v ^ (ones * '\n'))) {
+			break;
+		}
+	}
+
+	for(; pos < str.size(); ++pos) {
+		auto c = str[pos];
+		if(c == '\\' || c == ':' || c == '\n') {
+			break;
+		}
+	}
+
+	return pos;
+}
+
+// Parses a string, resolving escapes and multi-line continuations.
+// Returns a view into the input if the string contains neither,
+// otherwise the string is built in 'buf' and a view into it returned.
+inline std::string_view parseString(Parser& parser, Error& error,
+		std::string& buf) {
 	error = {ErrorType::none};
-	auto i = std::size_t(0);
 	auto indent = parser.location.nest.size();
-	std::string ret;
+	auto& in = parser.input;
 
-	while(i < parser.input.size()) {
-		if(i == 0u && parser.input[i] == '\t') {
-			error = {ErrorType::highIndentation, parser.location};
-			return {};
+	if(!in.empty() && in[0] == '\t') {
+		error = {ErrorType::highIndentation, parser.location};
+		return {};
+	}
+
+	auto i = findSpecial(in, 0u);
+	parser.location.col += i;
+	if(i == in.size() || in[i] != '\\') {
+		auto ret = in.substr(0, i);
+		in = in.substr(i);
+		return ret;
+	}
+
+	// slow path, copy runs between escapes into buf
+	buf.assign(in.data(), i);
+	while(i < in.size() && in[i] == '\\') {
+		if(in.size() == i + 1) {
+			// NOTE: weird case. input ends on backslash
+			buf += '\\';
+			in = {};
+			return buf;
 		}
 
-		if(parser.input[i] == '\\') {
-			if(parser.input.size() == i + 1) {
-				// NOTE: weird case. input ends on backslash
-				ret += '\\';
-				parser.input = {};
-				return ret;
-			}
+		++i;
+		++parser.location.col;
 
+		if(in[i] == '\n') {
+			// nothing to append
+			parser.location.col = 0;
+			++parser.location.line;
 			++i;
-			++parser.location.col;
 
-			if(parser.input[i] == '\\')  {
-				ret += '\\';
-			} else if(parser.input[i] == '\n') {
-				// nothing to append
-				parser.location.col = 0;
-				++parser.location.line;
-				++i;
-
-				if(parser.input.size() < i + indent) {
-					error = {ErrorType::unexpectedEnd, parser.location};
-					return {};
-				}
-
-				if(parser.input.find_first_not_of("\t", i) != i + indent) {
-					error = {ErrorType::lowIndentation, parser.location};
-					return {};
-				}
-
-				parser.location.col += indent;
-				i += indent;
-			} else if(parser.input[i] == ':') {
-				ret += ':';
+			if(in.size() < i + indent) {
+				error = {ErrorType::unexpectedEnd, parser.location};
+				return {};
 			}
-		} else if(parser.input[i] == ':' || parser.input[i] == '\n') {
-			break;
+
+			if(in.find_first_not_of('\t', i) != i + indent) {
+				error = {ErrorType::lowIndentation, parser.location};
+				return {};
+			}
+
+			parser.location.col += indent;
+			i += indent;
 		} else {
-			ret += parser.input[i];
+			if(in[i] == '\\' || in[i] == ':') {
+				buf += in[i];
+			}
+
+			++i;
+			++parser.location.col;
 		}
 
-		++i;
-		++parser.location.col;
+		auto next = findSpecial(in, i);
+		buf.append(in.data() + i, next - i);
+		parser.location.col += next - i;
+		i = next;
 	}
 
-	parser.input = parser.input.substr(i);
-	return ret;
+	in = in.substr(i);
+	return buf;
 }
 
-inline std::pair<std::string, Table> parseEntry(Parser& parser, Error& error, bool& success) {
+inline std::string parseString(Parser& parser, Error& error) {
+	std::string buf;
+	return std::string(parseString(parser, error, buf));
+}
+
+// When the parser has a projection, entries not matching it are
+// consumed and 'skipped' is set.
+// The name is parsed as view into the input and only copied into the
+// data model for entries that are kept.
+template<typename T = Table>
+typename T::value_type parseEntry(Parser& parser, Error& error,
+		bool& success, bool& skipped) {
 	error = {ErrorType::none};
 	success = false;
+	skipped = false;
 
 	auto first = parser.input.npos;
 	std::string_view after;
@@ -122,14 +228,24 @@ inline std::pair<std::string, Table> parseEntry(Parser& parser, Error& error, bo
 				return {};
 			}
 
+			if(parser.stats) {
+				++parser.stats->commentLines;
+			}
+
 			++parser.location.line;
 			parser.location.col = 0u;
 			parser.input = after.substr(nl + 1);
 			continue;
 		}
 
-		// Empty lines are also always allowed
+		// Empty lines are also always allowed. The newline that ends
+		// the line of the previous entry is found here as well (not at
+		// column 0), it's no blank line.
 		if(after[first] == '\n') {
+			if(parser.stats && parser.location.col == 0u) {
+				++parser.stats->blankLines;
+			}
+
 			++parser.location.line;
 			parser.location.col = 0u;
 			parser.input = after.substr(first + 1);
@@ -161,14 +277,29 @@ inline std::pair<std::string, Table> parseEntry(Parser& parser, Error& error, bo
 		return {};
 	}
 
-	auto name = parseString(parser, error);
+	std::string buf; // only used for strings with escapes
+	auto name = parseString(parser, error, buf);
 	if(error.type != ErrorType::none) {
 		return {};
 	}
 
+	auto match = PathMatch::inside;
+	if(!parser.projection.empty()) {
+		match = matchProjection(parser, name);
+	}
+
 	if(parser.input.empty() || parser.input[0] == '\n') {
 		success = true;
-		return {std::move(name), {}};
+		skipped = (match != PathMatch::inside);
+		if(skipped) {
+			return {};
+		}
+
+		if(parser.stats) {
+			++parser.stats->entries;
+		}
+
+		return {makeString<T>(parser, name), makeTable<T>(parser)};
 	}
 
 	assert(parser.input[0] == ':');
@@ -186,19 +317,33 @@ inline std::pair<std::string, Table> parseEntry(Parser& parser, Error& error, bo
 
 	// parse table mapping dst entry
 	parser.location.nest.push_back(name);
+	if(match != PathMatch::none && parser.stats) {
+		++parser.stats->entries;
+		++parser.stats->tables;
+		countDepth(parser.stats, parser.location.nest.size());
+	}
 
-	Table table;
+	auto table = makeTable<T>(parser);
 	if(parser.input[0] == '\n') {
 		++parser.location.line;
 		parser.location.col = 0;
 		parser.input = parser.input.substr(1);
 
 		// std::printf("table at %d{%s}\n", int(parser.location.nest.size()), parser.location.nest.back().data());
-		table = parseTable(parser, error);
+		if(match == PathMatch::none) {
+			skipTable(parser);
+		} else {
+			table = parseTable<T>(parser, error);
+		}
 		// std::printf("%d: entries: %d\n",int(parser.location.nest.size()), int(table.size()));
 	} else {
-		auto dst = parseString(parser, error);
-		table.push_back({std::move(dst), {}});
+		std::string dstBuf; // 'name' might reference buf
+		auto dst = parseString(parser, error, dstBuf);
+		if(match == PathMatch::inside || (match == PathMatch::ancestor &&
+				matchProjection(parser, dst) == PathMatch::inside)) {
+			// already counted as entry (and table) above
+			table.emplace_back(makeString<T>(parser, dst), makeTable<T>(parser));
+		}
 	}
 
 	assert(parser.location.nest.back() == name);
@@ -208,24 +353,44 @@ inline std::pair<std::string, Table> parseEntry(Parser& parser, Error& error, bo
 		return {};
 	}
 
+	// Ancestors of projected paths without any projected entries are
+	// dropped as well, empty tables would read as strings.
 	success = true;
-	return {std::move(name), std::move(table)};
+	skipped = (match == PathMatch::none) ||
+		(match == PathMatch::ancestor && table.empty());
+	if(skipped) {
+		return {};
+	}
+
+	return {makeString<T>(parser, name), std::move(table)};
 }
 
-inline Table parseTable(Parser& parser, Error& error) {
+template<typename T>
+T parseTable(Parser& parser, Error& error) {
+	StatsScope statsScope(parser.stats, &parser.input);
 	error = {ErrorType::none};
 
-	Table table;
+	auto table = makeTable<T>(parser);
 	auto success = true;
+	auto skipped = false;
 
 	while(true) {
-		auto entry = parseEntry(parser, error, success);
+		auto entry = parseEntry<T>(parser, error, success, skipped);
 		if(!success) {
 			break;
 		}
 
-		table.push_back(std::move(entry));
+		if(!skipped) {
+			table.push_back(std::move(entry));
+		}
 	}
 
 	return table;
 }
+
+// Parses the document into a pmr::Table allocated from 'memory'.
+inline pmr::Table parseTable(Parser& parser, Error& error,
+		std::pmr::memory_resource* memory) {
+	parser.memory = memory;
+	return parseTable<pmr::Table>(parser, error);
+}
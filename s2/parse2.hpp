@@ -3,14 +3,18 @@
 // Alternate parser, using callbacks.
 //
 // This one does not allocate a single byte of memory dynamically.
-// And it only needs the 'std::string_view' and 'std::size_t' features
-// from the stl, only features that could be easily replaced with standalones.
+// Besides 'std::string_view' and 'std::size_t' it only uses the path
+// matching and skipping helpers of ../common.hpp (which includes
+// <variant> and <tuple>) and the optional ParseStats of ../stats.hpp.
 //
 // Does not support multiline strings or escaping ':' (for now).
 //   (We don't support that so we don't ever have to copy strings.
 //    But I guess we could leave the un-escaping up to the callee?)
 
+#include "../common.hpp"
+#include "../stats.hpp"
 #include <string_view>
+#include <type_traits>
 #include <cassert>
 #include <cstdlib>
 
@@ -20,6 +24,11 @@
 // 	void exitTable(Parser&);
 // 	void entry(Parser&, std::string_view value);
 // };
+//
+// enterTable may also return a 'Handler*' or nothing. Returning a
+// nullptr skips the table: its lines are jumped over without being
+// tokenized, no callbacks are called for it (not even exitTable).
+// Returning nothing means the same handler is used for the table.
 
 struct Location {
 	unsigned line {};
@@ -30,12 +39,14 @@ struct Location {
 struct Parser {
 	std::string_view input;
 	Location location {};
+	ParseStats* stats {}; // optional
 };
 
 enum class ErrorType {
 	none,
 	unexpectedEnd,
 	highIndentation,
+	projectionTooDeep, // only for projections, see projection.hpp
 };
 
 struct Error {
@@ -47,6 +58,27 @@ struct Error {
 template<typename CB>
 void parseTable(CB& cb, Parser&, Error& error);
 
+// Returns a pointer to the handler for the table, see above.
+template<typename CB>
+auto enterTable(CB& cb, Parser& parser, std::string_view name) {
+	using Ret = decltype(cb.enterTable(parser, name));
+	if constexpr(std::is_void_v<Ret>) {
+		cb.enterTable(parser, name);
+		return &cb;
+	} else if constexpr(std::is_pointer_v<Ret>) {
+		return cb.enterTable(parser, name);
+	} else {
+		return &cb.enterTable(parser, name);
+	}
+}
+
+// Skips all lines belonging to the table at the current nesting
+// level, see skipIndented.
+inline void skipTable(Parser& parser) {
+	skipIndented(parser.input, parser.location.nest,
+		parser.location.line, parser.location.col);
+}
+
 inline std::string_view parseString(Parser& parser, Error& error) {
 	error = {ErrorType::none};
 	auto i = std::size_t(0);
@@ -99,14 +131,24 @@ inline bool parseEntry(CB& cb, Parser& parser, Error& error) {
 				return false;
 			}
 
+			if(parser.stats) {
+				++parser.stats->commentLines;
+			}
+
 			++parser.location.line;
 			parser.location.col = 0u;
 			parser.input = after.substr(nl + 1);
 			continue;
 		}
 
-		// Empty lines are also always allowed
+		// Empty lines are also always allowed. The newline that ends
+		// the line of the previous entry is found here as well (not at
+		// column 0), it's no blank line.
 		if(after[first] == '\n') {
+			if(parser.stats && parser.location.col == 0u) {
+				++parser.stats->blankLines;
+			}
+
 			++parser.location.line;
 			parser.location.col = 0u;
 			parser.input = after.substr(first + 1);
@@ -144,6 +186,10 @@ inline bool parseEntry(CB& cb, Parser& parser, Error& error) {
 	}
 
 	if(parser.input.empty() || parser.input[0] == '\n') {
+		if(parser.stats) {
+			++parser.stats->entries;
+		}
+
 		cb.entry(parser, name);
 		return true;
 	}
@@ -162,27 +208,43 @@ inline bool parseEntry(CB& cb, Parser& parser, Error& error) {
 	parser.input = parser.input.substr(tablePos);
 
 	// parse table mapping dst entry
-	auto& nextCB = cb.enterTable(parser, name);
+	auto* nextCB = enterTable(cb, parser, name);
 	++parser.location.nest;
 
+	if(nextCB && parser.stats) {
+		++parser.stats->entries;
+		++parser.stats->tables;
+		countDepth(parser.stats, parser.location.nest);
+	}
+
 	if(parser.input[0] == '\n') {
 		++parser.location.line;
 		parser.location.col = 0;
 		parser.input = parser.input.substr(1);
 
 		// std::printf("table at %d{%s}\n", int(parser.location.nest.size()), parser.location.nest.back().data());
-		parseTable(nextCB, parser, error);
+		if(nextCB) {
+			parseTable(*nextCB, parser, error);
+		} else {
+			skipTable(parser);
+		}
 		// std::printf("%d: entries: %d\n",int(parser.location.nest.size()), int(table.size()));
 	} else {
+		// already counted as entry (and table) above
 		auto dst = parseString(parser, error);
-		cb.entry(parser, dst);
+		if(nextCB) {
+			nextCB->entry(parser, dst);
+		}
 	}
 
 	if(error.type != ErrorType::none) {
 		return false;
 	}
 
-	cb.exitTable(parser);
+	if(nextCB) {
+		cb.exitTable(parser);
+	}
+
 	assert(parser.location.nest > 0);
 	--parser.location.nest;
 
@@ -191,6 +253,7 @@ inline bool parseEntry(CB& cb, Parser& parser, Error& error) {
 
 template<typename CB>
 inline void parseTable(CB& cb, Parser& parser, Error& error) {
+	StatsScope statsScope(parser.stats, &parser.input);
 	error = {ErrorType::none};
 	while(parseEntry(cb, parser, error)) /*noop*/ ;
 }
@@ -0,0 +1,175 @@
+#pragma once
+
+// Persistent (immutable, structurally shared) variant of the s2 Table.
+// Copying a PTable only copies a reference-counted pointer, modifications
+// return a new PTable that shares all unmodified subtrees with the old
+// one (path copying): only the entry arrays of the tables along the
+// modified path are copied. An update therefore costs O(depth * width),
+// with the number of entries of the tables along the path as width:
+// every entry (a name and a reference-counted pointer) of them is
+// copied, their subtrees are not. Old versions stay valid and
+// unchanged, so keeping several snapshots of a document (current,
+// pending, rollback) is cheap. Since nodes are never modified,
+// snapshots can be read concurrently from multiple threads.
+//
+// Paths are dotted names, e.g. "mie.scattering", each referring to the
+// first entry with that name.
+
+#include "data.hpp"
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+class PTable {
+public:
+	using Entry = std::pair<std::string, PTable>;
+
+	PTable() = default;
+	explicit PTable(std::vector<Entry> entries) : entries_(entries.empty() ?
+		nullptr : std::make_shared<const std::vector<Entry>>(std::move(entries))) {}
+
+	// The s2 representation of a string: a table with a single,
+	// empty entry.
+	static PTable string(std::string_view value) {
+		return PTable({{std::string(value), {}}});
+	}
+
+	std::size_t size() const { return entries_ ? entries_->size() : 0u; }
+	bool empty() const { return size() == 0u; }
+	const Entry* begin() const { return entries_ ? entries_->data() : nullptr; }
+	const Entry* end() const { return begin() + size(); }
+	const Entry& operator[](std::size_t i) const { return (*entries_)[i]; }
+
+	// Whether both share the same node, i.e. are (cheaply) known
+	// to be equal.
+	bool sameAs(const PTable& other) const { return entries_ == other.entries_; }
+
+	// Returns the table of the first entry with the given name.
+	const PTable* find(std::string_view name) const;
+
+	// Returns the table at the given path, nullptr if there is none.
+	const PTable* at(std::string_view path) const;
+
+	// Returns a copy in which the table at 'path' is 'value'.
+	// Missing entries along the path are appended.
+	PTable set(std::string_view path, PTable value) const;
+	PTable set(std::string_view path, std::string_view value) const {
+		return set(path, string(value));
+	}
+
+	// Returns a copy without the entry at 'path'.
+	// Returns the table itself if there is no such entry.
+	PTable remove(std::string_view path) const;
+
+	// Returns a copy with the entry appended.
+	PTable append(std::string_view name, PTable value) const;
+
+private:
+	std::shared_ptr<const std::vector<Entry>> entries_;
+
+	std::vector<Entry> copyEntries() const {
+		return entries_ ? *entries_ : std::vector<Entry>{};
+	}
+
+	std::size_t indexOf(std::string_view name) const;
+};
+
+inline std::size_t PTable::indexOf(std::string_view name) const {
+	for(auto i = 0u; i < size(); ++i) {
+		if((*entries_)[i].first == name) {
+			return i;
+		}
+	}
+
+	return size();
+}
+
+inline const PTable* PTable::find(std::string_view name) const {
+	auto i = indexOf(name);
+	return i < size() ? &(*entries_)[i].second : nullptr;
+}
+
+inline const PTable* PTable::at(std::string_view path) const {
+	auto* table = this;
+	while(table && !path.empty()) {
+		auto dot = path.find('.');
+		table = table->find(path.substr(0, dot));
+		path = (dot == path.npos) ? std::string_view{} : path.substr(dot + 1);
+	}
+
+	return table;
+}
+
+inline PTable PTable::set(std::string_view path, PTable value) const {
+	if(path.empty()) {
+		return value;
+	}
+
+	auto dot = path.find('.');
+	auto name = path.substr(0, dot);
+	auto rest = (dot == path.npos) ? std::string_view{} : path.substr(dot + 1);
+
+	auto entries = copyEntries();
+	auto i = indexOf(name);
+	if(i == entries.size()) {
+		entries.push_back({std::string(name), PTable{}.set(rest, std::move(value))});
+	} else {
+		auto& child = entries[i].second;
+		child = child.set(rest, std::move(value));
+	}
+
+	return PTable(std::move(entries));
+}
+
+inline PTable PTable::remove(std::string_view path) const {
+	auto dot = path.find('.');
+	auto name = path.substr(0, dot);
+	auto i = indexOf(name);
+	if(path.empty() || i == size()) {
+		return *this;
+	}
+
+	auto entries = copyEntries();
+	if(dot == path.npos) {
+		entries.erase(entries.begin() + i);
+	} else {
+		auto& child = entries[i].second;
+		auto removed = child.remove(path.substr(dot + 1));
+		if(removed.sameAs(child)) {
+			return *this;
+		}
+
+		child = std::move(removed);
+	}
+
+	return PTable(std::move(entries));
+}
+
+inline PTable PTable::append(std::string_view name, PTable value) const {
+	auto entries = copyEntries();
+	entries.push_back({std::string(name), std::move(value)});
+	return PTable(std::move(entries));
+}
+
+// Conversions from and to the mutable representation.
+inline PTable makePersistent(const Table& table) {
+	std::vector<PTable::Entry> entries;
+	entries.reserve(table.size());
+	for(auto& [name, child] : table) {
+		entries.push_back({name, makePersistent(child)});
+	}
+
+	return PTable(std::move(entries));
+}
+
+inline Table toTable(const PTable& table) {
+	Table ret;
+	ret.reserve(table.size());
+	for(auto& [name, child] : table) {
+		ret.emplace_back(name, toTable(child));
+	}
+
+	return ret;
+}
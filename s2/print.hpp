@@ -1,17 +1,35 @@
 #pragma once
 
 #include "data.hpp"
+#include "../stats.hpp"
 
-inline std::string print(const Table& table, unsigned indent = 0u) {
+// Appends 'str', escaping ':' and backslash so it can be parsed again.
+inline void printEscaped(std::string& ret, std::string_view str) {
+	auto pos = std::size_t(0);
+	while(true) {
+		auto next = str.find_first_of(":\\", pos);
+		ret += str.substr(pos, next - pos);
+		if(next == str.npos) {
+			break;
+		}
+
+		ret += '\\';
+		ret += str[next];
+		pos = next + 1;
+	}
+}
+
+// Works for Table and pmr::Table.
+template<typename T>
+std::string printTable(const T& table, unsigned indent) {
 	std::string ret;
 
-	// TODO: properly escape ':' and backslash again?
 	// TODO: support line breaks via multi-line strings?
 
 	std::string indentStr(indent, '\t');
 	for(auto& entry : table) {
 		ret += indentStr;
-		ret += entry.first;
+		printEscaped(ret, entry.first);
 		if(entry.second.empty()) {
 			ret += "\n";
 			continue;
@@ -19,15 +37,30 @@ inline std::string print(const Table& table, unsigned indent = 0u) {
 
 		ret += ": ";
 		if(entry.second.size() == 1 && entry.second[0].second.empty()) {
-			ret += entry.second[0].first;
+			printEscaped(ret, entry.second[0].first);
 			ret += "\n";
 			continue;
 		}
 
 		ret += "\n";
-		ret += print(entry.second, indent + 1);
+		ret += printTable(entry.second, indent + 1);
 	}
 
 	return ret;
 }
 
+inline std::string print(const Table& table, unsigned indent = 0u) {
+	return printTable(table, indent);
+}
+
+inline std::string print(const pmr::Table& table, unsigned indent = 0u) {
+	return printTable(table, indent);
+}
+
+// Like above, records allocations and written bytes in 'stats'.
+inline std::string print(const Table& table, ParseStats& stats) {
+	StatsScope statsScope(&stats);
+	auto ret = print(table);
+	stats.bytes += ret.size();
+	return ret;
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+// Path projection for the callback parser.
+// Only forwards the parts of a document that lie on or inside one of
+// the given dotted paths (e.g. "mie.scattering") to the wrapped handler.
+// All other tables are skipped via the 'nullptr' return of enterTable,
+// i.e. without tokenizing them.
+//
+// Like parse2.hpp, this does not allocate any memory.
+
+#include "parse2.hpp"
+
+// The wrapped handler is used for all nesting levels. It may itself
+// skip tables by returning a nullptr from enterTable.
+// The projected paths must not have more than MaxDepth segments, see
+// fits. parseTable below rejects them, when using Projected directly
+// they have to be checked beforehand.
+template<typename CB, unsigned MaxDepth = 32>
+struct Projected {
+	CB& cb;
+	const std::string_view* paths;
+	std::size_t count;
+
+	// Whether 'path' has at most MaxDepth segments.
+	static bool fits(std::string_view path) {
+		auto segments = 1u;
+		for(auto c : path) {
+			segments += (c == '.');
+			if(segments > MaxDepth) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	// Names of the current tables, only stored up to the depth at
+	// which we are inside a projected path.
+	std::string_view nest[MaxDepth] {};
+	unsigned depth {};
+	unsigned inside {}; // depth at which we got inside, 0 if not
+
+	// Matches the current path followed by 'name'.
+	PathMatch match(std::string_view name) const {
+		return matchPaths(paths, count, nest, depth, &name);
+	}
+
+	Projected* enterTable(Parser& parser, std::string_view name) {
+		if(!inside) {
+			// only an unchecked path deeper than MaxDepth could
+			// match here, see fits
+			auto m = depth < MaxDepth ? match(name) : PathMatch::none;
+			if(m == PathMatch::none) {
+				return nullptr;
+			}
+
+			nest[depth++] = name;
+			if(m == PathMatch::inside) {
+				inside = depth;
+			}
+		} else {
+			++depth;
+		}
+
+		if(!::enterTable(cb, parser, name)) {
+			if(inside == depth) {
+				inside = 0u;
+			}
+
+			--depth;
+			return nullptr;
+		}
+
+		return this;
+	}
+
+	void exitTable(Parser& parser) {
+		if(inside == depth) {
+			inside = 0u;
+		}
+
+		--depth;
+		cb.exitTable(parser);
+	}
+
+	void entry(Parser& parser, std::string_view value) {
+		// strings are tables without entries in the s2 model,
+		// so the value itself may be a projected path.
+		if(!inside && match(value) != PathMatch::inside) {
+			return;
+		}
+
+		cb.entry(parser, value);
+	}
+};
+
+// Fails with ErrorType::projectionTooDeep (the path as data) if one
+// of the paths is deeper than Projected supports.
+template<typename CB>
+void parseTable(CB& cb, Parser& parser, Error& error,
+		const std::string_view* paths, std::size_t count) {
+	for(auto i = std::size_t(0); i < count; ++i) {
+		if(!Projected<CB>::fits(paths[i])) {
+			error = {ErrorType::projectionTooDeep, parser.location, paths[i]};
+			return;
+		}
+	}
+
+	Projected<CB> projected {cb, paths, count};
+	parseTable(projected, parser, error);
+}
@@ -0,0 +1,170 @@
+#pragma once
+
+// Pull parser, alternative to the callbacks of parse2.hpp.
+// The caller requests the next event via 'Reader::next' instead of
+// being called back, the whole parsing state is stored in the Reader.
+//
+// Like parse2.hpp this does not allocate any memory, the returned
+// events only reference the input.
+
+#include "parse2.hpp"
+
+enum class EventKind {
+	enterTable, // 'value' is the name of the table
+	exitTable,
+	entry, // 'value' is the string
+	end, // reached end of input
+	error, // see Reader::error
+};
+
+struct Event {
+	EventKind kind;
+	std::string_view value {};
+	unsigned depth {}; // nesting level of the line the event belongs to
+	Location location {};
+};
+
+struct Reader {
+	Parser parser;
+	Error error {ErrorType::none};
+
+	// Value of an inline table ('name: value'), returned as entry
+	// after the enterTable event.
+	std::string_view inlineValue {};
+	Location inlineLocation {};
+
+	enum class Pending {
+		none,
+		entry, // inlineValue
+		exit, // exitTable of an inline table
+	} pending {};
+
+	Event next();
+
+	// Skips the remaining content of the innermost table that was
+	// entered, including its exitTable event.
+	// Like skipTable, this only checks the indentation of lines.
+	void skipSubtree();
+};
+
+inline Event Reader::next() {
+	auto& loc = parser.location;
+	if(pending == Pending::entry) {
+		pending = Pending::exit;
+		return {EventKind::entry, inlineValue, loc.nest, inlineLocation};
+	} else if(pending == Pending::exit) {
+		pending = Pending::none;
+		--loc.nest;
+		return {EventKind::exitTable, {}, loc.nest, loc};
+	}
+
+	if(error.type != ErrorType::none) {
+		return {EventKind::error, {}, loc.nest, error.location};
+	}
+
+	auto first = parser.input.npos;
+	while(!parser.input.empty()) {
+		auto after = parser.input;
+		first = after.find_first_not_of('\t');
+		if(first == after.npos) {
+			loc.col += after.size();
+			parser.input = {}; // reached end of document
+			break;
+		}
+
+		// Comment, skip to next line.
+		// Comments don't have to be aligned, we don't care.
+		if(after[first] == '#') {
+			auto nl = after.find('\n');
+			if(nl == after.npos) {
+				loc.col += after.size();
+				parser.input = {};
+				break;
+			}
+
+			++loc.line;
+			loc.col = 0u;
+			parser.input = after.substr(nl + 1);
+			continue;
+		}
+
+		// Empty lines are also always allowed
+		if(after[first] == '\n') {
+			++loc.line;
+			loc.col = 0u;
+			parser.input = after.substr(first + 1);
+			continue;
+		}
+
+		break;
+	}
+
+	// indentation is too low (or input ended), the current table ends
+	if(parser.input.empty() || first < loc.nest) {
+		if(loc.nest == 0u) {
+			return {EventKind::end, {}, 0u, loc};
+		}
+
+		--loc.nest;
+		return {EventKind::exitTable, {}, loc.nest, loc};
+	}
+
+	// indentation is suddenly too high
+	if(first > loc.nest) {
+		error = {ErrorType::highIndentation, loc};
+		return {EventKind::error, {}, loc.nest, loc};
+	}
+
+	loc.col += first;
+	parser.input = parser.input.substr(first);
+
+	auto nameLoc = loc;
+	auto name = parseString(parser, error);
+	if(error.type != ErrorType::none) {
+		return {EventKind::error, {}, loc.nest, error.location};
+	}
+
+	if(parser.input.empty() || parser.input[0] == '\n') {
+		return {EventKind::entry, name, loc.nest, nameLoc};
+	}
+
+	assert(parser.input[0] == ':');
+
+	auto tablePos = parser.input.find_first_not_of("\t ", 1);
+	if(tablePos == parser.input.npos) {
+		// empty table of form `name:` not allowed per grammar
+		error = {ErrorType::unexpectedEnd, loc};
+		return {EventKind::error, {}, loc.nest, loc};
+	}
+
+	loc.col += tablePos;
+	parser.input = parser.input.substr(tablePos);
+
+	auto depth = loc.nest++;
+	if(parser.input[0] == '\n') {
+		++loc.line;
+		loc.col = 0;
+		parser.input = parser.input.substr(1);
+	} else {
+		inlineLocation = loc;
+		inlineValue = parseString(parser, error);
+		if(error.type != ErrorType::none) {
+			return {EventKind::error, {}, loc.nest, error.location};
+		}
+
+		pending = Pending::entry;
+	}
+
+	return {EventKind::enterTable, name, depth, nameLoc};
+}
+
+inline void Reader::skipSubtree() {
+	assert(parser.location.nest > 0);
+	if(pending != Pending::none) {
+		pending = Pending::none;
+	} else {
+		skipTable(parser);
+	}
+
+	--parser.location.nest;
+}
@@ -0,0 +1,546 @@
+#pragma once
+
+// Schema validation on the event stream of parse2.hpp, in a single pass
+// and without building a table. Subtrees the schema doesn't constrain
+// are skipped without being tokenized. All violations are reported,
+// with their locations.
+//
+// The schema itself is a document, describing the root table:
+//
+// closed: true # only the listed fields are allowed
+// other: # alternatively the schema for all fields that aren't listed
+// 	type: table
+// fields:
+// 	name:
+// 		type: string
+// 		required: true
+// 	g:
+// 		type: number # or integer
+// 		min: -1
+// 		max: 1
+// 	rgb:
+// 		type: array
+// 		items: number
+// 		minItems: 3
+// 		maxItems: 3
+// 	mie:
+// 		type: table # implied by 'fields'
+// 		fields:
+// 			...
+//
+// Types are 'any' (default, not validated), 'string' and 'number' or
+// 'integer' (single values, 'name: value'), 'array' (only values) and
+// 'table' (named entries; values are treated like fields without
+// content). 'min' and 'max' also apply to the items of number arrays.
+//
+// compileSchema turns it into a flat array of nodes: the fields of a
+// node are stored contiguously and sorted by name, so a lookup is a
+// binary search over adjacent memory.
+
+#include "data.hpp"
+#include "parse2.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+enum class SchemaType : std::uint8_t {
+	any,
+	string,
+	number,
+	integer,
+	array,
+	table,
+};
+
+struct Schema {
+	struct Node {
+		SchemaType type {SchemaType::any};
+		SchemaType items {SchemaType::any}; // for arrays
+		bool required {};
+		bool closed {};
+		bool hasRequired {}; // whether any of the fields is required
+		bool hasMin {};
+		bool hasMax {};
+		double min {};
+		double max {};
+		std::uint32_t minItems {0u};
+		std::uint32_t maxItems {UINT32_MAX};
+		std::uint32_t fields {}; // index of the first field in 'nodes'
+		std::uint32_t fieldCount {};
+		std::uint32_t other {}; // index of the schema for other fields, 0 if none
+		std::uint32_t nameOffset {}; // into 'names'
+		std::uint32_t nameSize {};
+	};
+
+	std::vector<Node> nodes; // nodes[0] is the root
+	std::vector<char> names; // vector: stable data on move
+
+	const Node& root() const { return nodes[0]; }
+
+	std::string_view name(const Node& node) const {
+		return {names.data() + node.nameOffset, node.nameSize};
+	}
+
+	// Returns the index of the field, fieldCount if there is none.
+	std::uint32_t findField(const Node& node, std::string_view fname) const {
+		auto begin = nodes.begin() + node.fields;
+		auto end = begin + node.fieldCount;
+		auto it = std::lower_bound(begin, end, fname,
+			[&](const Node& field, std::string_view n) { return name(field) < n; });
+		if(it == end || name(*it) != fname) {
+			return node.fieldCount;
+		}
+
+		return std::uint32_t(it - begin);
+	}
+};
+
+namespace detail {
+
+// parse2 handler building an s2 Table, for the schema document.
+// Deeper tables couldn't be validated (see Validator), they are
+// recorded in 'tooDeep' to fail the compilation.
+struct SchemaTableBuilder {
+	Table* nest[64];
+	unsigned depth {1u};
+	std::optional<Location> tooDeep {};
+
+	SchemaTableBuilder* enterTable(Parser& parser, std::string_view name) {
+		if(depth == 64u) {
+			if(!tooDeep) {
+				tooDeep = parser.location;
+			}
+
+			return nullptr;
+		}
+
+		auto& entry = nest[depth - 1]->emplace_back(std::string(name), Table{});
+		nest[depth++] = &entry.second;
+		return this;
+	}
+
+	void exitTable(Parser&) {
+		--depth;
+	}
+
+	void entry(Parser&, std::string_view value) {
+		nest[depth - 1]->emplace_back(std::string(value), Table{});
+	}
+};
+
+inline std::optional<SchemaType> parseSchemaType(std::string_view str) {
+	if(str == "any") return SchemaType::any;
+	if(str == "string") return SchemaType::string;
+	if(str == "number") return SchemaType::number;
+	if(str == "integer") return SchemaType::integer;
+	if(str == "array") return SchemaType::array;
+	if(str == "table") return SchemaType::table;
+	return std::nullopt;
+}
+
+template<typename T>
+bool parseNumber(std::string_view str, T& out) {
+	auto end = str.data() + str.size();
+	auto res = std::from_chars(str.data(), end, out);
+	return res.ec == std::errc{} && res.ptr == end;
+}
+
+// The value of 'name: value', nullopt if the table has another form.
+inline std::optional<std::string_view> schemaValue(const Table& table) {
+	if(table.size() != 1u || !table[0].second.empty()) {
+		return std::nullopt;
+	}
+
+	return std::string_view(table[0].first);
+}
+
+inline bool compileNode(Schema& schema, std::uint32_t index, const Table& def,
+		std::string& error) {
+	auto fail = [&](std::string_view key, const char* what) {
+		error = std::string(key) + ": ";
+		error += what;
+		return false;
+	};
+
+	const Table* fields {};
+	const Table* other {};
+	auto hasType = false;
+	for(auto& [key, content] : def) {
+		auto& node = schema.nodes[index];
+		if(key == "fields") {
+			fields = &content;
+			continue;
+		} else if(key == "other") {
+			other = &content;
+			continue;
+		}
+
+		auto val = schemaValue(content);
+		if(!val) {
+			return fail(key, "expected a value");
+		}
+
+		auto flag = [&](bool& out) {
+			out = (*val == "true");
+			return out || *val == "false";
+		};
+
+		auto ok = true;
+		if(key == "type") {
+			auto type = parseSchemaType(*val);
+			ok = bool(type);
+			node.type = type.value_or(SchemaType::any);
+			hasType = true;
+		} else if(key == "items") {
+			auto type = parseSchemaType(*val);
+			ok = type && *type != SchemaType::array && *type != SchemaType::table;
+			node.items = type.value_or(SchemaType::any);
+		} else if(key == "required") {
+			ok = flag(node.required);
+		} else if(key == "closed") {
+			ok = flag(node.closed);
+		} else if(key == "min") {
+			ok = node.hasMin = parseNumber(*val, node.min);
+		} else if(key == "max") {
+			ok = node.hasMax = parseNumber(*val, node.max);
+		} else if(key == "minItems") {
+			ok = parseNumber(*val, node.minItems);
+		} else if(key == "maxItems") {
+			ok = parseNumber(*val, node.maxItems);
+		} else {
+			return fail(key, "unknown schema key");
+		}
+
+		if(!ok) {
+			return fail(key, "invalid value");
+		}
+	}
+
+	if(!fields && !other) {
+		return true;
+	}
+
+	if(hasType && schema.nodes[index].type != SchemaType::table) {
+		return fail(fields ? "fields" : "other", "only allowed for tables");
+	}
+
+	if(other && schema.nodes[index].closed) {
+		return fail("other", "not allowed for closed tables");
+	}
+
+	schema.nodes[index].type = SchemaType::table;
+	if(other) {
+		auto oi = std::uint32_t(schema.nodes.size());
+		schema.nodes.emplace_back();
+		schema.nodes[index].other = oi;
+		if(!compileNode(schema, oi, *other, error)) {
+			error = "other." + error;
+			return false;
+		}
+	}
+
+	if(!fields) {
+		return true;
+	}
+
+	// sorted, contiguous fields
+	std::vector<const std::pair<std::string, Table>*> sorted;
+	for(auto& field : *fields) {
+		sorted.push_back(&field);
+	}
+
+	std::sort(sorted.begin(), sorted.end(),
+		[](auto* a, auto* b) { return a->first < b->first; });
+	for(auto i = 1u; i < sorted.size(); ++i) {
+		if(sorted[i]->first == sorted[i - 1]->first) {
+			return fail(sorted[i]->first, "duplicate field");
+		}
+	}
+
+	auto first = std::uint32_t(schema.nodes.size());
+	schema.nodes.resize(first + sorted.size());
+	schema.nodes[index].fields = first;
+	schema.nodes[index].fieldCount = std::uint32_t(sorted.size());
+
+	for(auto i = 0u; i < sorted.size(); ++i) {
+		auto& [name, content] = *sorted[i];
+		auto& field = schema.nodes[first + i];
+		field.nameOffset = std::uint32_t(schema.names.size());
+		field.nameSize = std::uint32_t(name.size());
+		schema.names.insert(schema.names.end(), name.begin(), name.end());
+		if(!compileNode(schema, first + i, content, error)) {
+			error = name + "." + error;
+			return false;
+		}
+
+		// 'compileNode' might have reallocated the nodes
+		if(schema.nodes[first + i].required) {
+			schema.nodes[index].hasRequired = true;
+		}
+	}
+
+	return true;
+}
+
+} // namespace detail
+
+// Compiles the schema document. Returns nullopt and sets 'error'
+// (if not null) if it is invalid.
+inline std::optional<Schema> compileSchema(std::string_view source,
+		std::string* error = nullptr) {
+	Table def;
+	detail::SchemaTableBuilder builder {{&def}};
+	Parser parser{source};
+	Error perror;
+	parseTable(builder, parser, perror);
+
+	std::string err;
+	if(perror.type != ErrorType::none) {
+		err = "parse error at line " + std::to_string(perror.location.line + 1);
+	} else if(builder.tooDeep) {
+		err = "nested too deeply at line " + std::to_string(builder.tooDeep->line + 1);
+	} else {
+		Schema schema;
+		schema.nodes.resize(1u);
+		schema.nodes[0].type = SchemaType::table;
+		if(detail::compileNode(schema, 0u, def, err)) {
+			return schema;
+		}
+	}
+
+	if(error) {
+		*error = std::move(err);
+	}
+
+	return std::nullopt;
+}
+
+enum class ViolationType {
+	missingField, // 'name' is the name of the missing field
+	unknownField, // field not allowed in closed table
+	wrongType,
+	outOfRange,
+	tooFewItems,
+	tooManyItems,
+};
+
+struct Violation {
+	ViolationType type;
+	Location location;
+	std::string_view name; // of the field, references the input or schema
+};
+
+// parse2 handler validating the document against the schema.
+// See 'validate' below for usage.
+template<unsigned MaxDepth = 64>
+struct Validator {
+	struct Frame {
+		const Schema::Node* node;
+		Location location;
+		std::string_view name;
+		std::uint32_t values {}; // value entries
+		std::uint32_t tables {}; // table entries
+		std::size_t seen {}; // offset of the seen-bits in 'seen'
+		bool failed {}; // already reported a wrong type
+	};
+
+	const Schema& schema;
+	std::vector<Violation>& violations;
+	Frame nest[MaxDepth];
+	unsigned depth {1u};
+
+	// Bits of the fields seen in the current tables, to find missing
+	// required ones. Only grows up to the maximum nesting.
+	std::vector<std::uint64_t> seen;
+
+	Validator(const Schema& s, std::vector<Violation>& v) :
+			schema(s), violations(v) {
+		nest[0] = {&schema.root(), {}, {}};
+		pushSeen(nest[0]);
+	}
+
+	void report(ViolationType type, const Location& loc, std::string_view name) {
+		violations.push_back({type, loc, name});
+	}
+
+	void pushSeen(Frame& frame) {
+		frame.seen = seen.size();
+		if(frame.node->hasRequired) {
+			seen.resize(seen.size() + (frame.node->fieldCount + 63) / 64);
+		}
+	}
+
+	// Looks up a field of the current table, reports unknown ones.
+	// Returns nullptr if there is nothing to validate.
+	const Schema::Node* field(Frame& frame, Parser& parser, std::string_view name) {
+		auto& node = *frame.node;
+		auto i = schema.findField(node, name);
+		if(i == node.fieldCount) {
+			if(node.other) {
+				return &schema.nodes[node.other];
+			}
+
+			if(node.closed) {
+				report(ViolationType::unknownField, parser.location, name);
+			}
+
+			return nullptr;
+		}
+
+		if(node.hasRequired) {
+			seen[frame.seen + i / 64] |= std::uint64_t(1u) << (i % 64);
+		}
+
+		return &schema.nodes[node.fields + i];
+	}
+
+	Validator* enterTable(Parser& parser, std::string_view name) {
+		auto& frame = nest[depth - 1];
+		++frame.tables;
+		if(frame.failed) {
+			return nullptr;
+		}
+
+		if(frame.node->type != SchemaType::table && frame.node->type != SchemaType::any) {
+			report(ViolationType::wrongType, frame.location, frame.name);
+			frame.failed = true;
+			return nullptr;
+		}
+
+		auto* child = field(frame, parser, name);
+		if(!child || (child->type == SchemaType::any && child->fieldCount == 0u &&
+				!child->other)) {
+			return nullptr; // skipped without tokenizing
+		}
+
+		assert(depth < MaxDepth);
+		auto& next = nest[depth++];
+		next = {child, parser.location, name};
+		pushSeen(next);
+		return this;
+	}
+
+	// Checks a single value against number types and ranges.
+	void checkValue(const Schema::Node& node, SchemaType type, Parser& parser,
+			std::string_view value, std::string_view name) {
+		double num;
+		if(type == SchemaType::number) {
+			if(!detail::parseNumber(value, num)) {
+				report(ViolationType::wrongType, parser.location, name);
+				return;
+			}
+		} else if(type == SchemaType::integer) {
+			std::int64_t i;
+			if(!detail::parseNumber(value, i)) {
+				report(ViolationType::wrongType, parser.location, name);
+				return;
+			}
+
+			num = double(i);
+		} else {
+			return;
+		}
+
+		if((node.hasMin && num < node.min) || (node.hasMax && num > node.max)) {
+			report(ViolationType::outOfRange, parser.location, name);
+		}
+	}
+
+	void entry(Parser& parser, std::string_view value) {
+		auto& frame = nest[depth - 1];
+		++frame.values;
+		if(frame.failed) {
+			return;
+		}
+
+		auto& node = *frame.node;
+		switch(node.type) {
+			case SchemaType::table: {
+				auto* child = field(frame, parser, value);
+				if(child && child->type != SchemaType::any) {
+					report(ViolationType::wrongType, parser.location, value);
+				}
+				break;
+			} case SchemaType::string:
+			case SchemaType::number:
+			case SchemaType::integer:
+				if(frame.values > 1u) {
+					report(ViolationType::wrongType, frame.location, frame.name);
+					frame.failed = true;
+				} else {
+					checkValue(node, node.type, parser, value, frame.name);
+				}
+				break;
+			case SchemaType::array:
+				checkValue(node, node.items, parser, value, frame.name);
+				break;
+			case SchemaType::any:
+				if(node.fieldCount > 0u || node.other) {
+					field(frame, parser, value);
+				}
+				break;
+		}
+	}
+
+	// Checks the table that is finished, i.e. the counts and the
+	// required fields.
+	void finish(Frame& frame) {
+		auto& node = *frame.node;
+		if(!frame.failed) {
+			switch(node.type) {
+				case SchemaType::string:
+				case SchemaType::number:
+				case SchemaType::integer:
+					if(frame.values != 1u || frame.tables != 0u) {
+						report(ViolationType::wrongType, frame.location, frame.name);
+					}
+					break;
+				case SchemaType::array:
+					if(frame.values < node.minItems) {
+						report(ViolationType::tooFewItems, frame.location, frame.name);
+					} else if(frame.values > node.maxItems) {
+						report(ViolationType::tooManyItems, frame.location, frame.name);
+					}
+					break;
+				default:
+					break;
+			}
+		}
+
+		if(node.hasRequired) {
+			for(auto i = 0u; i < node.fieldCount; ++i) {
+				auto& field = schema.nodes[node.fields + i];
+				auto bit = seen[frame.seen + i / 64] & (std::uint64_t(1u) << (i % 64));
+				if(field.required && !bit) {
+					report(ViolationType::missingField, frame.location, schema.name(field));
+				}
+			}
+		}
+
+		seen.resize(frame.seen);
+	}
+
+	void exitTable(Parser&) {
+		finish(nest[--depth]);
+	}
+};
+
+// Validates the document in 'parser' against the schema.
+// Returns whether the document is valid, i.e. could be parsed and
+// has no violations. Violations are appended to 'violations'.
+inline bool validate(const Schema& schema, Parser& parser, Error& error,
+		std::vector<Violation>& violations) {
+	auto count = violations.size();
+	Validator<> validator(schema, violations);
+	parseTable(validator, parser, error);
+	if(error.type != ErrorType::none) {
+		return false;
+	}
+
+	validator.finish(validator.nest[0]);
+	return violations.size() == count;
+}
@@ -1,8 +1,13 @@
 #pragma once
 
+#include "blob.hpp"
 #include "common.hpp"
+#include "stats.hpp"
 
+#include <algorithm>
 #include <array>
+#include <charconv>
+#include <map>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -11,22 +16,55 @@
 #include <tuple>
 #include <utility>
 #include <type_traits>
+#include <unordered_map>
+
+// Path of the current value. Has a fixed capacity so that tracking
+// it never allocates, segments deeper than that are only counted.
+struct Nest {
+	static constexpr auto capacity = 32u;
+
+	struct Segment {
+		std::string_view name; // empty for array elements
+		unsigned index {}; // for array elements
+	};
+
+	std::array<Segment, capacity> segments {};
+	unsigned depth {};
+
+	std::size_t size() const { return depth; }
+	bool empty() const { return depth == 0u; }
+
+	void push(std::string_view name, unsigned index = 0u) {
+		if(depth < capacity) {
+			segments[depth] = {name, index};
+		}
+		++depth;
+	}
+
+	void pop() {
+		assert(depth > 0u);
+		--depth;
+	}
+};
 
 struct Location {
 	unsigned line {};
 	unsigned col {}; // NOTE: should probably be (utf-8) char instead of byte
-	std::vector<std::string_view> nest {};
+	Nest nest {};
 };
 
 struct Parser {
 	std::string_view input;
 	Location location {};
+	ParseStats* stats {}; // optional
 };
 
 struct Printer {
 	std::string out;
 	unsigned ident;
 	bool inArray;
+	ParseStats* stats {}; // optional
+	bool blobs {}; // print vectors and arrays of numbers as blobs, see blob.hpp
 };
 
 enum class ErrorType {
@@ -41,6 +79,7 @@ enum class ErrorType {
 	fixedArrayTooMany,
 	fixedArrayNotEnough,
 	emptyName,
+	invalidBlob,
 
 	/*
 	mixedTableArray,
@@ -59,11 +98,17 @@ template<typename T> using ParseResult = std::variant<T, ErrorType>;
 template<typename T, typename = void> struct Serializer;
 
 template<typename T> ParseResult<T> parse(Parser& parser) {
+	StatsScope statsScope(parser.stats, &parser.input);
 	return Serializer<T>::parse(parser);
 }
 
 template<typename T> void print(Printer& printer, const T& val) {
-	return Serializer<T>::print(printer, val);
+	StatsScope statsScope(printer.stats);
+	auto size = printer.out.size();
+	Serializer<T>::print(printer, val);
+	if(printer.stats && printer.stats->scopes == 1u) {
+		printer.stats->bytes += printer.out.size() - size;
+	}
 }
 
 template<typename T>
@@ -146,7 +191,13 @@ struct Serializer {
 	static void print(Printer& printer, const T& val) {
 		if constexpr(std::is_same_v<T, std::string> || std::is_same_v<T, std::string>) {
 			printer.out += val;
-		} else if constexpr(std::is_integral_v<T> || std::is_floating_point_v<T>) {
+		} else if constexpr(std::is_floating_point_v<T>) {
+			// shortest text that parses back to the same value,
+			// std::to_string would round to 6 decimals
+			char buf[64];
+			auto res = std::to_chars(buf, buf + sizeof(buf), val);
+			printer.out.append(buf, res.ptr);
+		} else if constexpr(std::is_integral_v<T>) {
 			printer.out += std::to_string(val);
 		} else {
 			static_assert(templatize<T>(false), "Can't print primitive type");
@@ -177,6 +228,10 @@ ErrorType processLine(Parser& parser, bool& done, bool& skip) {
 			return ErrorType::none;
 		}
 
+		if(parser.stats) {
+			++parser.stats->commentLines;
+		}
+
 		++parser.location.line;
 		parser.location.col = 0u;
 		parser.input = content.substr(nl + 1);
@@ -187,6 +242,10 @@ ErrorType processLine(Parser& parser, bool& done, bool& skip) {
 
 	// Empty lines are also always allowed
 	if(content[first] == '\n') {
+		if(parser.stats) {
+			++parser.stats->blankLines;
+		}
+
 		++parser.location.line;
 		parser.location.col = 0u;
 		parser.input = content.substr(first + 1);
@@ -230,10 +289,69 @@ ErrorType getLine(Parser& parser, bool& done) {
 	return ErrorType::none;
 }
 
+// Disengaged optionals aren't printed at all, neither in tables
+// nor in arrays (they can't be represented).
+template<typename T> bool absent(const T&) { return false; }
+template<typename T> bool absent(const std::optional<T>& val) { return !val; }
+
+// Parses the blob (see blob.hpp) in the current line. 'items(count)'
+// returns where to decode the items to, nullptr if count is invalid.
+template<typename T, typename F>
+ErrorType parseBlobLine(Parser& parser, F&& items) {
+	if constexpr(!blobType<T>().has_value()) {
+		(void) parser;
+		(void) items;
+		return ErrorType::invalidBlob;
+	} else {
+		auto& str = parser.input;
+		auto [line, next] = splitIf(str, str.find('\n'));
+		auto blob = parseBlob(line);
+		if(!blob) {
+			return ErrorType::invalidBlob;
+		}
+
+		T* out = items(blob->count);
+		if(!out || !decodeBlob(*blob, out)) {
+			return ErrorType::invalidBlob;
+		}
+
+		str = next;
+		if(!next.empty()) {
+			++parser.location.line;
+			parser.location.col = 0u;
+		} else {
+			parser.location.col += line.size();
+		}
+
+		return ErrorType::none;
+	}
+}
+
+// Whether parser.input starts with a blob. Only vectors and arrays of
+// numbers can be blobs, for others it's just a string.
+template<typename T>
+bool atBlob(const Parser& parser) {
+	return blobType<T>() && !parser.input.empty() && parser.input[0] == '@';
+}
+
 template<typename T>
 struct Serializer<std::vector<T>> {
 	static ParseResult<std::vector<T>> parse(Parser& parser) {
 		std::vector<T> res;
+		auto resize = [&](std::size_t count) {
+			res.resize(count);
+			return res.data();
+		};
+
+		// blob as inline value, 'name: @f32/3 ...'
+		auto blob = atBlob<T>(parser);
+		if(blob) {
+			auto err = parseBlobLine<T>(parser, resize);
+			if(err != ErrorType::none) {
+				return err;
+			}
+		}
+
 		while(!parser.input.empty()) {
 			bool done;
 			auto err = getLine(parser, done);
@@ -249,13 +367,29 @@ struct Serializer<std::vector<T>> {
 				return ErrorType::unexpectedEnd;
 			}
 
+			// a blob must be the only item
+			if(blob) {
+				return ErrorType::invalidBlob;
+			}
+
+			if(res.empty() && atBlob<T>(parser)) {
+				blob = true;
+				err = parseBlobLine<T>(parser, resize);
+				if(err != ErrorType::none) {
+					return err;
+				}
+
+				continue;
+			}
+
 			// NOTE: extended array-nest syntax
 			bool nested = false;
 			if(!parser.input.empty() && parser.input.substr(0, 2) == "-\n") {
 				parser.input = parser.input.substr(2);
 				parser.location.col = 0u;
 				++parser.location.line;
-				parser.location.nest.push_back(std::to_string(res.size()));
+				parser.location.nest.push({}, unsigned(res.size()));
+				countDepth(parser.stats, parser.location.nest.size());
 				nested = true;
 			}
 
@@ -265,10 +399,18 @@ struct Serializer<std::vector<T>> {
 			}
 
 			if(nested) {
-				parser.location.nest.pop_back();
+				parser.location.nest.pop();
 			}
 
 			res.emplace_back(std::move(std::get<T>(r)));
+			if(parser.stats) {
+				++parser.stats->entries;
+			}
+		}
+
+		if(parser.stats) {
+			parser.stats->entries += blob ? res.size() : 0u;
+			++parser.stats->arrays;
 		}
 
 		return res;
@@ -281,7 +423,23 @@ struct Serializer<std::vector<T>> {
 			++printer.ident;
 		}
 
+		if constexpr(blobType<T>().has_value()) {
+			if(printer.blobs && !val.empty()) {
+				printer.out += '\n';
+				printer.out.append(printer.ident, '\t');
+				printBlob(printer.out, val.data(), val.size());
+				if(inArray) {
+					--printer.ident;
+				}
+				return;
+			}
+		}
+
 		for(auto& e : val) {
+			if(absent(e)) {
+				continue;
+			}
+
 			printer.inArray = true;
 			printer.out += '\n';
 			printer.out.append(printer.ident, '\t');
@@ -300,6 +458,20 @@ struct Serializer<std::array<T, N>> {
 	static ParseResult<std::array<T, N>> parse(Parser& parser) {
 		std::array<T, N> res;
 		auto i = 0u;
+		auto fill = [&](std::size_t count) {
+			i = N;
+			return count == N ? res.data() : nullptr;
+		};
+
+		// blob as inline value, 'name: @f32/3 ...'
+		auto blob = atBlob<T>(parser);
+		if(blob) {
+			auto err = parseBlobLine<T>(parser, fill);
+			if(err != ErrorType::none) {
+				return err;
+			}
+		}
+
 		while(!parser.input.empty()) {
 			bool done;
 			auto err = getLine(parser, done);
@@ -311,13 +483,29 @@ struct Serializer<std::array<T, N>> {
 				break;
 			}
 
+			// a blob must be the only item
+			if(blob) {
+				return ErrorType::invalidBlob;
+			}
+
+			if(i == 0u && atBlob<T>(parser)) {
+				blob = true;
+				err = parseBlobLine<T>(parser, fill);
+				if(err != ErrorType::none) {
+					return err;
+				}
+
+				continue;
+			}
+
 			// NOTE: extended array-nest syntax
 			bool nested = false;
 			if(!parser.input.empty() && parser.input.substr(0, 2) == "-\n") {
 				parser.input = parser.input.substr(2);
 				parser.location.col = 0u;
 				++parser.location.line;
-				parser.location.nest.push_back(std::to_string(i));
+				parser.location.nest.push({}, i);
+				countDepth(parser.stats, parser.location.nest.size());
 				nested = true;
 			}
 
@@ -327,7 +515,7 @@ struct Serializer<std::array<T, N>> {
 			}
 
 			if(nested) {
-				parser.location.nest.pop_back();
+				parser.location.nest.pop();
 			}
 
 			if(i >= res.size()) {
@@ -342,6 +530,11 @@ struct Serializer<std::array<T, N>> {
 			return ErrorType::fixedArrayNotEnough;
 		}
 
+		if(parser.stats) {
+			parser.stats->entries += i;
+			++parser.stats->arrays;
+		}
+
 		return res;
 	}
 
@@ -352,11 +545,288 @@ struct Serializer<std::array<T, N>> {
 			++printer.ident;
 		}
 
+		if constexpr(blobType<T>().has_value()) {
+			if(printer.blobs && N > 0u) {
+				printer.out += '\n';
+				printer.out.append(printer.ident, '\t');
+				printBlob(printer.out, val.data(), N);
+				if(inArray) {
+					--printer.ident;
+				}
+				return;
+			}
+		}
+
 		for(auto& e : val) {
+			if(absent(e)) {
+				continue;
+			}
+
+			printer.inArray = true;
+			printer.out += '\n';
+			printer.out.append(printer.ident, '\t');
+			::print(printer, e);
+		}
+
+		if(inArray) {
+			--printer.ident;
+		}
+		printer.inArray = inArray;
+	}
+};
+
+template<typename T>
+struct Serializer<std::optional<T>> {
+	static ParseResult<std::optional<T>> parse(Parser& parser) {
+		auto r = ::parse<T>(parser);
+		if(auto err = std::get_if<ErrorType>(&r)) {
+			return *err;
+		}
+
+		return std::optional<T>(std::move(std::get<T>(r)));
+	}
+
+	// Only called for engaged optionals, see 'absent'.
+	static void print(Printer& printer, const std::optional<T>& val) {
+		if(val) {
+			::print(printer, *val);
+		}
+	}
+};
+
+// Pairs are arrays with exactly two elements.
+template<typename A, typename B>
+struct Serializer<std::pair<A, B>> {
+	static ParseResult<std::pair<A, B>> parse(Parser& parser) {
+		std::pair<A, B> res;
+		auto item = [&](auto& dst) {
+			using V = std::remove_reference_t<decltype(dst)>;
+			auto r = ::parse<V>(parser);
+			if(auto err = std::get_if<ErrorType>(&r)) {
+				return *err;
+			}
+
+			dst = std::move(std::get<V>(r));
+			return ErrorType::none;
+		};
+
+		auto i = 0u;
+		while(!parser.input.empty()) {
+			bool done;
+			auto err = getLine(parser, done);
+			if(err != ErrorType::none) {
+				return err;
+			}
+
+			if(done) {
+				break;
+			}
+
+			if(i >= 2u) {
+				return ErrorType::fixedArrayTooMany;
+			}
+
+			// NOTE: extended array-nest syntax
+			bool nested = false;
+			if(parser.input.substr(0, 2) == "-\n") {
+				parser.input = parser.input.substr(2);
+				parser.location.col = 0u;
+				++parser.location.line;
+				parser.location.nest.push({}, i);
+				countDepth(parser.stats, parser.location.nest.size());
+				nested = true;
+			}
+
+			err = (i == 0u) ? item(res.first) : item(res.second);
+			if(err != ErrorType::none) {
+				return err;
+			}
+
+			if(nested) {
+				parser.location.nest.pop();
+			}
+
+			++i;
+		}
+
+		if(i < 2u) {
+			return ErrorType::fixedArrayNotEnough;
+		}
+
+		if(parser.stats) {
+			parser.stats->entries += 2u;
+			++parser.stats->arrays;
+		}
+
+		return ParseResult<std::pair<A, B>>(std::move(res));
+	}
+
+	static void print(Printer& printer, const std::pair<A, B>& val) {
+		auto inArray = printer.inArray;
+		if(inArray) {
+			printer.out += "-\n";
+			++printer.ident;
+		}
+
+		auto item = [&](auto& e) {
 			printer.inArray = true;
 			printer.out += '\n';
 			printer.out.append(printer.ident, '\t');
 			::print(printer, e);
+		};
+
+		item(val.first);
+		item(val.second);
+
+		if(inArray) {
+			--printer.ident;
+		}
+		printer.inArray = inArray;
+	}
+};
+
+// Counts the entries of the table or array at the given indentation
+// at the start of 'input', without parsing them. Only looks at the
+// start of each line.
+inline std::size_t countEntries(std::string_view input, std::size_t indent) {
+	auto count = std::size_t(0);
+	while(!input.empty()) {
+		auto first = input.find_first_not_of('\t');
+		if(first == input.npos) {
+			break;
+		}
+
+		auto c = input[first];
+		if(c != '\n' && c != '#') {
+			if(first < indent) {
+				break;
+			}
+
+			count += (first == indent);
+		}
+
+		auto nl = input.find('\n', first);
+		if(nl == input.npos) {
+			break;
+		}
+
+		input = input.substr(nl + 1);
+	}
+
+	return count;
+}
+
+template<typename M, typename = void>
+struct HasReserve : std::false_type {};
+
+template<typename M>
+struct HasReserve<M, std::void_t<decltype(std::declval<M&>().reserve(0u))>> :
+	std::true_type {};
+
+// Tables with arbitrary names, parsed directly into a
+// std::map or std::unordered_map with std::string keys.
+// Hash maps are reserved up front, by counting the lines of the table.
+template<typename M>
+struct MapSerializer {
+	using T = typename M::mapped_type;
+
+	static ParseResult<M> parse(Parser& parser) {
+		M res;
+		if constexpr(HasReserve<M>::value) {
+			res.reserve(countEntries(parser.input, parser.location.nest.size()));
+		}
+
+		while(!parser.input.empty()) {
+			bool done;
+			auto err = getLine(parser, done);
+			if(err != ErrorType::none) {
+				return err;
+			}
+
+			if(done) {
+				break;
+			}
+
+			auto content = parser.input;
+			if(content.empty()) {
+				return ErrorType::unexpectedEnd;
+			}
+
+			auto nl = content.find('\n');
+			auto line = content.substr(0, nl);
+			auto sep = line.find(':');
+			if(sep == line.npos) {
+				return ErrorType::podNonTableEntry;
+			}
+
+			auto [name, val] = split(line, sep);
+			if(name.empty()) {
+				return ErrorType::emptyName;
+			}
+
+			// removing leading space in val
+			if(!val.empty() && val[0] == ' ') {
+				val.remove_prefix(1);
+			}
+
+			if(val.empty()) {
+				parser.input = (nl == content.npos) ? std::string_view{} : content.substr(nl + 1);
+				parser.location.col = 0u;
+				++parser.location.line;
+			} else {
+				parser.location.col += val.data() - content.data();
+				parser.input = content.substr(val.data() - line.data());
+			}
+
+			parser.location.nest.push(name);
+			countDepth(parser.stats, parser.location.nest.size());
+
+			auto r = ::parse<T>(parser);
+			if(auto err = std::get_if<ErrorType>(&r)) {
+				return *err;
+			}
+
+			parser.location.nest.pop();
+
+			auto [it, inserted] = res.try_emplace(std::string(name),
+				std::move(std::get<T>(r)));
+			if(!inserted) {
+				return ErrorType::podDuplicateEntry;
+			}
+
+			if(parser.stats) {
+				++parser.stats->entries;
+			}
+		}
+
+		if(parser.stats) {
+			++parser.stats->tables;
+		}
+
+		return ParseResult<M>(std::move(res));
+	}
+
+	static void print(Printer& printer, const M& val) {
+		auto inArray = printer.inArray;
+		if(inArray) {
+			printer.out += "-\n";
+			++printer.ident;
+		}
+
+		for(auto& [name, e] : val) {
+			if(absent(e)) {
+				continue;
+			}
+
+			printer.out += '\n';
+			printer.out.append(printer.ident, '\t');
+			printer.out += name;
+			printer.out += ": ";
+
+			printer.inArray = false;
+			++printer.ident;
+			::print(printer, e);
+			--printer.ident;
 		}
 
 		if(inArray) {
@@ -366,6 +836,53 @@ struct Serializer<std::array<T, N>> {
 	}
 };
 
+template<typename T, typename C, typename A>
+struct Serializer<std::map<std::string, T, C, A>> :
+	MapSerializer<std::map<std::string, T, C, A>> {};
+
+template<typename T, typename H, typename E, typename A>
+struct Serializer<std::unordered_map<std::string, T, H, E, A>> :
+	MapSerializer<std::unordered_map<std::string, T, H, E, A>> {};
+
+template<typename T>
+ErrorType parseMapEntry(Parser& parser, MapEntry<T>& entry) {
+	auto r = ::parse<T>(parser);
+	if(auto err = std::get_if<ErrorType>(&r)) {
+		return *err;
+	}
+
+	entry.val = std::move(std::get<T>(r));
+	return ErrorType::none;
+}
+
+template<typename C>
+ErrorType parseMapEntry(Parser& parser, ColumnEntry<C>& entry) {
+	using T = typename C::value_type;
+	auto r = ::parse<T>(parser);
+	if(auto err = std::get_if<ErrorType>(&r)) {
+		return *err;
+	}
+
+	entry.val.emplace_back(std::move(std::get<T>(r)));
+	return ErrorType::none;
+}
+
+// If the entry 'name' lies inside the table 'prefix.sub', returns
+// that prefix as substring of 'name'. Returns an empty view otherwise.
+inline std::string_view subPrefix(std::string_view name,
+		std::string_view prefix, std::string_view sub) {
+	auto pl = prefix.empty() ? 0u : prefix.length() + 1;
+	if(name.length() <= pl + sub.length() ||
+			(pl > 0u && (name.substr(0, prefix.length()) != prefix ||
+				name[prefix.length()] != '.')) ||
+			name.substr(pl, sub.length()) != sub ||
+			name[pl + sub.length()] != '.') {
+		return {};
+	}
+
+	return name.substr(0, pl + sub.length());
+}
+
 template<typename M>
 ErrorType parse(Parser& parser, M& map, std::string_view prefix = "") {
 	while(!parser.input.empty()) {
@@ -417,7 +934,8 @@ ErrorType parse(Parser& parser, M& map, std::string_view prefix = "") {
 			parser.input = content.substr(val.data() - line.data());
 		}
 
-		parser.location.nest.push_back(name);
+		parser.location.nest.push(name);
+		countDepth(parser.stats, parser.location.nest.size());
 
 		// search for binding
 		err = ErrorType::none;
@@ -443,17 +961,11 @@ ErrorType parse(Parser& parser, M& map, std::string_view prefix = "") {
 			}
 
 			entry.done = true;
-			auto& v = entry.val;
-			using V = std::remove_reference_t<decltype(v)>;
-
-			ParseResult<V> r;
-			r = ::parse<V>(parser);
-			if(auto nerr = std::get_if<ErrorType>(&r)) {
-				err = *nerr;
-				return true; // break for each
+			err = parseMapEntry(parser, entry);
+			if(err == ErrorType::none && parser.stats) {
+				++parser.stats->entries;
 			}
 
-			v = std::move(std::get<V>(r));
 			return true; // break for each
 		});
 
@@ -462,16 +974,17 @@ ErrorType parse(Parser& parser, M& map, std::string_view prefix = "") {
 		}
 
 		if(!found) {
-			// try to parse it as sub-object
-			// TODO: can be optimized. Check for sub-objects in iteration
-			// already, break iteration if found.
-			// If not found, don't even attempt it here and return
-			// podInvalidEntry
+			// try to parse it as sub-object. The prefix is a substring
+			// of the name of an entry inside of it, no need to build it.
+			auto nprefix = std::string_view {};
 			if(val.empty()) {
-				std::string nprefix = std::string(prefix);
-				if(!nprefix.empty()) nprefix += ".";
-				nprefix += name;
+				for_each_or(map, [&, ename = name](auto& entry) {
+					nprefix = subPrefix(entry.name, prefix, ename);
+					return !nprefix.empty();
+				});
+			}
 
+			if(!nprefix.empty()) {
 				auto err = ::parse(parser, map, nprefix);
 				if(err != ErrorType::none) {
 					return err;
@@ -481,7 +994,11 @@ ErrorType parse(Parser& parser, M& map, std::string_view prefix = "") {
 			}
 		}
 
-		parser.location.nest.pop_back();
+		parser.location.nest.pop();
+	}
+
+	if(parser.stats) {
+		++parser.stats->tables;
 	}
 
 	return ErrorType::none;
@@ -503,6 +1020,10 @@ void print(Printer& printer, M& map, std::string_view prefix = "") {
 
 		auto pl = prefix.empty() ? 0u : prefix.length() + 1;
 		auto name = entry.name.substr(pl);
+		if(absent(entry.val)) {
+			entry.done = true;
+			return false;
+		}
 
 		printer.out += "\n";
 		printer.out.append(printer.ident, '\t');
@@ -518,9 +1039,7 @@ void print(Printer& printer, M& map, std::string_view prefix = "") {
 			printer.out += name;
 			printer.out += ": ";
 
-			auto nprefix = std::string(prefix);
-			if(!nprefix.empty()) nprefix += ".";
-			nprefix += name;
+			auto nprefix = entry.name.substr(0, pl + sep);
 
 			++printer.ident;
 			::print(printer, map, nprefix);
@@ -570,7 +1089,7 @@ struct PodSerializer {
 			return ErrorType::podMissingField;
 		}
 
-		return ParseResult<T>(res);
+		return ParseResult<T>(std::move(res));
 	}
 
 	static void print(Printer& printer, const T& val) {
@@ -578,3 +1097,163 @@ struct PodSerializer {
 		::print(printer, map);
 	}
 };
+
+// Counts the records ('-' lines) of the array at the given indentation
+// at the start of 'input', without parsing them. Only looks at the
+// start of each line.
+inline std::size_t countRecords(std::string_view input, std::size_t indent) {
+	auto count = std::size_t(0);
+	while(!input.empty()) {
+		auto first = input.find_first_not_of('\t');
+		if(first == input.npos) {
+			break;
+		}
+
+		auto c = input[first];
+		if(first < indent && c != '\n' && c != '#') {
+			break;
+		}
+
+		if(first == indent && c == '-' && input.substr(first, 2) == "-\n") {
+			++count;
+		}
+
+		auto nl = input.find('\n', first);
+		if(nl == input.npos) {
+			break;
+		}
+
+		input = input.substr(nl + 1);
+	}
+
+	return count;
+}
+
+// Parses an array of records (in array-nest syntax) into columns:
+// every entry of the map is a ColumnEntry and each record appends one
+// value to each column. No row structs are created, the columns are
+// reserved up front. Missing optional fields are value-initialized so
+// all columns keep the same length.
+template<typename M>
+ErrorType parseColumns(Parser& parser, M& map) {
+	auto count = countRecords(parser.input, parser.location.nest.size());
+	for_each_or(map, [&](auto& entry) {
+		entry.val.reserve(entry.val.size() + count);
+		return false;
+	});
+
+	auto row = 0u;
+	while(!parser.input.empty()) {
+		bool done;
+		auto err = getLine(parser, done);
+		if(err != ErrorType::none) {
+			return err;
+		}
+
+		if(done) {
+			break;
+		}
+
+		if(parser.input.substr(0, 2) != "-\n") {
+			return ErrorType::podNonTableEntry;
+		}
+
+		parser.input = parser.input.substr(2);
+		parser.location.col = 0u;
+		++parser.location.line;
+		parser.location.nest.push({}, row);
+		countDepth(parser.stats, parser.location.nest.size());
+
+		for_each_or(map, [](auto& entry) {
+			entry.done = false;
+			return false;
+		});
+
+		err = ::parse(parser, map);
+		if(err != ErrorType::none) {
+			return err;
+		}
+
+		auto missing = for_each_or(map, [](auto& entry) {
+			if(entry.done) {
+				return false;
+			}
+
+			if(entry.required) {
+				return true;
+			}
+
+			entry.val.emplace_back();
+			return false;
+		});
+
+		if(missing) {
+			return ErrorType::podMissingField;
+		}
+
+		parser.location.nest.pop();
+		++row;
+	}
+
+	if(parser.stats) {
+		parser.stats->entries += row;
+		++parser.stats->arrays;
+	}
+
+	return ErrorType::none;
+}
+
+// Prints the columns as array of records, the inverse of parseColumns.
+// Columns of different lengths are only printed up to the shortest one.
+template<typename M>
+void printColumns(Printer& printer, M& map) {
+	auto rows = std::size_t(0);
+	if constexpr(std::tuple_size_v<M> > 0) {
+		rows = std::apply([](auto&... entries) {
+			return std::min({entries.val.size()...});
+		}, map);
+	}
+
+	auto inArray = printer.inArray;
+	if(inArray) {
+		printer.out += "-\n";
+		++printer.ident;
+	}
+
+	for(auto i = 0u; i < rows; ++i) {
+		auto row = std::apply([&](auto&... entries) {
+			return std::tuple{MapEntry{entries.name, entries.val[i]}...};
+		}, map);
+
+		printer.inArray = true;
+		printer.out += '\n';
+		printer.out.append(printer.ident, '\t');
+		::print(printer, row);
+	}
+
+	if(inArray) {
+		--printer.ident;
+	}
+	printer.inArray = inArray;
+}
+
+// Like PodSerializer but for a struct of columns, see parseColumns.
+// D::map must return a tuple of ColumnEntry.
+template<typename T, typename D = Serializer<T>>
+struct ColumnSerializer {
+	static ParseResult<T> parse(Parser& parser) {
+		T res {};
+		auto map = D::map(res);
+		auto err = parseColumns(parser, map);
+		if(err != ErrorType::none) {
+			return err;
+		}
+
+		return ParseResult<T>(std::move(res));
+	}
+
+	static void print(Printer& printer, const T& val) {
+		auto map = D::map(val);
+		printColumns(printer, map);
+	}
+};
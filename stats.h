@@ -0,0 +1,19 @@
+#pragma once
+
+// Optional statistics about a parse run, for the C parsers.
+// Pass a pointer via parser.stats to fill it. Counters are only
+// ever increased, a single object can be used for multiple runs.
+
+#include <stddef.h>
+
+struct parse_stats {
+	size_t allocations; // number of malloc/realloc calls
+	size_t allocated_bytes;
+	unsigned max_depth;
+	size_t tables;
+	size_t arrays;
+	size_t entries; // values in tables or arrays
+	size_t bytes; // scanned
+	size_t comment_lines;
+	size_t blank_lines;
+};
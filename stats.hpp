@@ -0,0 +1,74 @@
+#pragma once
+
+// Optional statistics about a parse or print run, for the C++ parsers
+// and printers. Pass a pointer via Parser::stats (or Printer::stats) to
+// fill it. Counters are only ever increased, a single object can be
+// used for multiple runs.
+
+#include <cstddef>
+#include <string_view>
+
+struct AllocStats {
+	std::size_t count {};
+	std::size_t bytes {};
+};
+
+// Heap allocations made by the calling thread so far.
+// Only counted when the operator new replacement from alloc_counter.hpp
+// is linked into the program, always zero otherwise.
+inline AllocStats& threadAllocations() {
+	static thread_local AllocStats stats;
+	return stats;
+}
+
+struct ParseStats {
+	AllocStats allocations {};
+	unsigned maxDepth {};
+	std::size_t tables {};
+	std::size_t arrays {};
+	std::size_t entries {}; // values in tables or arrays
+	std::size_t bytes {}; // scanned (parsers) or written (printers)
+	std::size_t commentLines {};
+	std::size_t blankLines {};
+
+	unsigned scopes {}; // see StatsScope
+};
+
+// Records the allocations made (and input bytes consumed, if given)
+// while the outermost scope for a stats object is alive.
+// Parse functions are recursive, nested scopes are ignored.
+struct StatsScope {
+	ParseStats* stats;
+	const std::string_view* input {};
+	AllocStats start {};
+	std::size_t inputSize {};
+
+	StatsScope(ParseStats* s, const std::string_view* in = nullptr) :
+			stats(s) {
+		if(stats && stats->scopes++ == 0u) {
+			input = in;
+			inputSize = in ? in->size() : 0u;
+			start = threadAllocations();
+		}
+	}
+
+	~StatsScope() {
+		if(stats && --stats->scopes == 0u) {
+			auto& now = threadAllocations();
+			stats->allocations.count += now.count - start.count;
+			stats->allocations.bytes += now.bytes - start.bytes;
+			if(input) {
+				stats->bytes += inputSize - input->size();
+			}
+		}
+	}
+
+	StatsScope(const StatsScope&) = delete;
+	StatsScope& operator=(const StatsScope&) = delete;
+};
+
+inline void countDepth(ParseStats* stats, std::size_t depth) {
+	if(stats && depth > stats->maxDepth) {
+		stats->maxDepth = unsigned(depth);
+	}
+}
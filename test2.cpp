@@ -6,23 +6,92 @@
 #include <string>
 #include <iostream>
 
-// TODO: test this api
-struct Dummy {
-	int a;
-	float b;
+struct Layer {
+	std::string name;
+	float g;
+	float scaleHeight;
+	std::vector<float> rgb;
+	int id;
 };
 
 template<>
-struct ValueParser<Dummy> : public PodParser<Dummy> {
-	template<typename DummyCV>
-	static constexpr auto map(DummyCV& dummy) {
+struct ValueParser<Layer> : public PodParser<Layer> {
+	template<typename LayerCV>
+	static constexpr auto map(LayerCV& layer) {
 		return std::tuple {
-			MapEntry{"a", dummy.a},
-			MapEntry{"b", dummy.b},
+			MapEntry{"name", layer.name, true},
+			MapEntry{"mie.g", layer.g, true},
+			MapEntry{"mie.scale_height", layer.scaleHeight},
+			MapEntry{"mie.scattering.rgb", layer.rgb, true},
+			MapEntry{"id", layer.id},
 		};
 	}
 };
 
+std::optional<Layer> parseLayer(std::string_view input) {
+	Parser parser{input};
+	auto res = parseTableOrArray(parser);
+	if(std::holds_alternative<Error>(res)) {
+		return std::nullopt;
+	}
+
+	return as<Layer>(std::get<NamedValue>(res).value);
+}
+
+// Checks the PodParser binding of Layer: dotted prefixes, missing
+// required and optional fields and fields that can't be parsed.
+bool checkPodParser() {
+	auto full = parseLayer(
+		"name: haze\n"
+		"id: 7\n"
+		"other: ignored\n"
+		"mie:\n"
+		"\tg: 0.8\n"
+		"\tscale_height: 1200\n"
+		"\tscattering:\n"
+		"\t\trgb:\n"
+		"\t\t\t1\n"
+		"\t\t\t2\n"
+		"\t\t\t3\n"
+		"\tunknown: 1\n");
+	if(!full || full->name != "haze" || full->id != 7 || full->g != 0.8f ||
+			full->scaleHeight != 1200.f || full->rgb != std::vector{1.f, 2.f, 3.f}) {
+		std::printf("PodParser: unexpected values\n");
+		return false;
+	}
+
+	// optional fields are value-initialized
+	auto optional = parseLayer(
+		"name: haze\nmie:\n\tg: 0.8\n\tscattering:\n\t\trgb:\n\t\t\t1\n");
+	if(!optional || optional->id != 0 || optional->scaleHeight != 0.f ||
+			optional->rgb != std::vector{1.f}) {
+		std::printf("PodParser: optional fields not defaulted\n");
+		return false;
+	}
+
+	const char* invalid[] = {
+		// required 'mie.g' missing
+		"name: haze\nmie:\n\tscattering:\n\t\trgb:\n\t\t\t1\n",
+		// required 'mie.scattering.rgb' missing, prefix isn't a table
+		"name: haze\nmie:\n\tg: 0.8\n\tscattering: none\n",
+		// 'mie' isn't a table
+		"name: haze\nmie: 0.8\n",
+		// unparseable required and optional fields
+		"name: haze\nmie:\n\tg: high\n\tscattering:\n\t\trgb:\n\t\t\t1\n",
+		"name: haze\nid: seven\nmie:\n\tg: 0.8\n\tscattering:\n\t\trgb:\n\t\t\t1\n",
+		"name: haze\nmie:\n\tg: 0.8\n\tscattering:\n\t\trgb:\n\t\t\tred\n",
+	};
+
+	for(auto* input : invalid) {
+		if(parseLayer(input)) {
+			std::printf("PodParser: accepted invalid input\n%s", input);
+			return false;
+		}
+	}
+
+	return true;
+}
+
 std::string readFile(std::string_view filename) {
 	auto openmode = std::ios::ate;
 	std::ifstream ifs(std::string{filename}, openmode);
@@ -40,6 +109,10 @@ std::string readFile(std::string_view filename) {
 }
 
 int main(int argc, const char** argv) {
+	if(!checkPodParser()) {
+		return EXIT_FAILURE;
+	}
+
 	if(argc < 2) {
 		std::printf("No input file given\n");
 		return EXIT_FAILURE;
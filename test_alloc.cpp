@@ -0,0 +1,108 @@
+// Checks that the parsers promising to not allocate memory really don't.
+// Usage: test_alloc <files>...
+#include "alloc_counter.hpp"
+#include "s2/pull.hpp"
+#include "parse_cb.h"
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+std::string readFile(std::string_view filename) {
+	auto openmode = std::ios::ate;
+	std::ifstream ifs(std::string{filename}, openmode);
+	ifs.exceptions(std::ostream::failbit | std::ostream::badbit);
+
+	auto size = ifs.tellg();
+	ifs.seekg(0, std::ios::beg);
+
+	std::string buffer;
+	buffer.resize(size);
+	auto data = reinterpret_cast<char*>(buffer.data());
+	ifs.read(data, size);
+
+	return buffer;
+}
+
+struct Handler {
+	void enterTable(Parser&, std::string_view) {}
+	void exitTable(Parser&) {}
+	void entry(Parser&, std::string_view) {}
+};
+
+void cbHandler(struct parser*, const char*, const char*) {
+}
+
+bool check(const char* file, const char* name, AllocStats allocs) {
+	if(allocs.count == 0u) {
+		return true;
+	}
+
+	std::printf("%s: %s made %zu allocations (%zu bytes)\n",
+		file, name, allocs.count, allocs.bytes);
+	return false;
+}
+
+// Counts of s2/parse2.hpp for a small document, the newline ending
+// an entry must not be counted as blank line.
+bool checkStats() {
+	std::string doc = "a\nb\nc: d\ne:\n\tf\n\tg\n\n# c\n";
+	ParseStats stats;
+	Parser parser{doc};
+	parser.stats = &stats;
+	Handler handler;
+	Error error;
+	parseTable(handler, parser, error);
+
+	if(stats.blankLines != 1u || stats.commentLines != 1u ||
+			stats.entries != 6u || stats.tables != 2u) {
+		std::printf("stats: unexpected counts\n");
+		return false;
+	}
+
+	return true;
+}
+
+int main(int argc, const char** argv) {
+	if(argc < 2) {
+		std::printf("No input file given\n");
+		return EXIT_FAILURE;
+	}
+
+	auto success = checkStats();
+	for(auto i = 1; i < argc; ++i) {
+		auto file = readFile(argv[i]);
+
+		ParseStats stats;
+		success &= check(argv[i], "s2/parse2.hpp", countAllocations([&]{
+			Parser parser{file};
+			parser.stats = &stats;
+			Handler handler;
+			Error error;
+			parseTable(handler, parser, error);
+		}));
+
+		success &= check(argv[i], "s2/pull.hpp", countAllocations([&]{
+			Reader reader{{file}};
+			auto ev = reader.next();
+			while(ev.kind != EventKind::end && ev.kind != EventKind::error) {
+				ev = reader.next();
+			}
+		}));
+
+		struct parse_stats cbStats {};
+		success &= check(argv[i], "parse_cb.h", countAllocations([&]{
+			struct parse_result res = {};
+			res.parser.stream = (void*) file.c_str();
+			res.parser.read = parser_read_mem;
+			res.parser.cb = cbHandler;
+			res.parser.stats = &cbStats;
+			parse_table_or_array(&res.parser);
+		}));
+
+		std::printf("%s: %zu entries, %zu tables, depth %u, %zu comments, "
+			"%zu bytes\n", argv[i], stats.entries, stats.tables,
+			stats.maxDepth, stats.commentLines, stats.bytes);
+	}
+
+	return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
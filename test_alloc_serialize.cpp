@@ -0,0 +1,116 @@
+// Checks that binding a document to a struct via serialize.hpp doesn't
+// allocate anything apart from the containers of the struct itself.
+// Usage: test_alloc_serialize tests/atmosphere.qwe
+#include "alloc_counter.hpp"
+#include "serialize.hpp"
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+struct Atmosphere {
+	float bottom;
+	float top;
+	float sunAngularRadius;
+	float minMuS;
+	float groundAlbedo;
+
+	struct {
+		float g;
+		float scaleHeight;
+		struct {
+			std::array<float, 3> rgb;
+		} scattering;
+	} mie;
+
+	struct {
+		float scaleHeight;
+		struct {
+			std::array<float, 3> rgb;
+		} scattering;
+	} rayleigh;
+
+	struct {
+		std::array<float, 3> rgb;
+		struct {
+			float start;
+			float end;
+			std::vector<float> values;
+		} spectral;
+	} solarIrradiance;
+};
+
+template<> struct Serializer<Atmosphere> : public PodSerializer<Atmosphere> {
+	template<typename AtmosCV>
+	static constexpr auto map(AtmosCV& atmos) {
+		auto& si = atmos.solarIrradiance;
+		return std::tuple{
+			MapEntry{"bottom", atmos.bottom, true},
+			MapEntry{"top", atmos.top, true},
+			MapEntry{"sun_angular_radius", atmos.sunAngularRadius, true},
+			MapEntry{"min_mu_s", atmos.minMuS, true},
+			MapEntry{"ground_albedo", atmos.groundAlbedo, true},
+
+			MapEntry{"mie.g", atmos.mie.g, true},
+			MapEntry{"mie.scale_height", atmos.mie.scaleHeight, true},
+			MapEntry{"mie.scattering.rgb", atmos.mie.scattering.rgb, true},
+
+			MapEntry{"rayleigh.scale_height", atmos.rayleigh.scaleHeight, true},
+			MapEntry{"rayleigh.scattering.rgb", atmos.rayleigh.scattering.rgb, true},
+
+			MapEntry{"solar_irradiance.rgb", si.rgb, true},
+			MapEntry{"solar_irradiance.spectral.start", si.spectral.start, true},
+			MapEntry{"solar_irradiance.spectral.end", si.spectral.end, true},
+			MapEntry{"solar_irradiance.spectral.values", si.spectral.values, true},
+		};
+	}
+};
+
+std::string readFile(std::string_view filename) {
+	auto openmode = std::ios::ate;
+	std::ifstream ifs(std::string{filename}, openmode);
+	ifs.exceptions(std::ostream::failbit | std::ostream::badbit);
+
+	auto size = ifs.tellg();
+	ifs.seekg(0, std::ios::beg);
+
+	std::string buffer;
+	buffer.resize(size);
+	auto data = reinterpret_cast<char*>(buffer.data());
+	ifs.read(data, size);
+
+	return buffer;
+}
+
+int main(int argc, const char** argv) {
+	if(argc < 2) {
+		std::printf("No input file given\n");
+		return EXIT_FAILURE;
+	}
+
+	auto file = readFile(argv[1]);
+
+	ParseResult<Atmosphere> pr;
+	Parser parser{file};
+	auto allocs = countAllocations([&]{
+		pr = parse<Atmosphere>(parser);
+	});
+
+	if(auto err = std::get_if<ErrorType>(&pr); err) {
+		std::printf("error %d at %d:%d\n", (unsigned) *err,
+			1 + parser.location.line, 1 + parser.location.col);
+		return EXIT_FAILURE;
+	}
+
+	// The only allocations expected are the ones growing the vector
+	auto& values = std::get<Atmosphere>(pr).solarIrradiance.spectral.values;
+	auto expected = countAllocations([&]{
+		std::vector<float> vec;
+		for(auto v : values) {
+			vec.emplace_back(v);
+		}
+	});
+
+	std::printf("%zu allocations (%zu bytes), %zu expected (%zu bytes)\n",
+		allocs.count, allocs.bytes, expected.count, expected.bytes);
+	return allocs.count == expected.count ? EXIT_SUCCESS : EXIT_FAILURE;
+}
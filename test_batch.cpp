@@ -0,0 +1,104 @@
+// Checks that the batched delivery of parse_cb.h yields the same events
+// as the plain callbacks, also when the batch is flushed often or
+// reused, and that too small batches are rejected.
+// Usage: test_batch [file], defaults to tests/atmosphere.qwe.
+#include "parse_cb.h"
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+using Event = std::tuple<std::string, std::string, std::string, unsigned>;
+using Events = std::vector<Event>; // nest, name, value, line
+
+void collect(struct parser* parser, const char* name, const char* value) {
+	static_cast<Events*>(parser->user)->push_back({parser->nest_buf,
+		name ? name : "", value, parser->location.line});
+}
+
+void collectBatch(struct parser* parser, const struct parse_event* events,
+		unsigned count) {
+	auto& out = *static_cast<Events*>(parser->user);
+	for(auto i = 0u; i < count; ++i) {
+		auto& ev = events[i];
+		if(std::string(ev.nest).size() != ev.nest_len) {
+			std::printf("nest_len doesn't match nest\n");
+			std::exit(EXIT_FAILURE);
+		}
+
+		out.push_back({ev.nest, ev.name ? ev.name : "", ev.value, ev.line});
+	}
+}
+
+int main(int argc, const char** argv) {
+	auto file = argc > 1 ? argv[1] : "tests/atmosphere.qwe";
+
+	Events plain;
+	auto res = parse_file(file, collect, &plain);
+	if(res.error != error_type_none || plain.empty()) {
+		std::printf("%s: parse failed\n", file);
+		return EXIT_FAILURE;
+	}
+
+	std::ifstream ifs(file);
+	std::stringstream ss;
+	ss << ifs.rdbuf();
+	auto input = ss.str();
+
+	for(auto capacity : {1u, 3u, 1024u}) {
+		std::vector<parse_event> events(capacity);
+		std::vector<char> data(MAX_LINE_SIZE + MAX_NEST_SIZE);
+
+		parse_batch batch {};
+		batch.cb = collectBatch;
+		batch.events = events.data();
+		batch.capacity = capacity;
+		batch.data = data.data();
+		batch.data_size = data.size();
+
+		// run twice with the same batch through both entry points,
+		// state must not leak
+		for(auto run = 0u; run < 4u; ++run) {
+			Events batched;
+			res = run % 2u ? parse_string_batched(input.c_str(), &batch, &batched) :
+				parse_file_batched(file, &batch, &batched);
+			if(res.error != error_type_none || batched != plain) {
+				std::printf("capacity %u, run %u: events differ\n", capacity, run);
+				return EXIT_FAILURE;
+			}
+
+			// leftover state, e.g. from an aborted parse
+			batch.count = capacity / 2u;
+			batch.data_len = 1u;
+			batch.nest = data.data();
+		}
+	}
+
+	// batches too small for a single line are rejected
+	std::vector<parse_event> events(4u);
+	std::vector<char> data(MAX_LINE_SIZE);
+	parse_batch small {};
+	small.cb = collectBatch;
+	small.events = events.data();
+	small.capacity = 4u;
+	small.data = data.data();
+	small.data_size = data.size();
+
+	Events none;
+	auto noEvents = small;
+	noEvents.capacity = 0u;
+	noEvents.data_size = MAX_LINE_SIZE + MAX_NEST_SIZE;
+	if(parse_string_batched(input.c_str(), &small, &none).error !=
+				error_type_invalid_batch ||
+			parse_file_batched(file, &small, &none).error != error_type_invalid_batch ||
+			parse_string_batched(input.c_str(), &noEvents, &none).error !=
+				error_type_invalid_batch || !none.empty()) {
+		std::printf("too small batch accepted\n");
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,187 @@
+// Checks the base64 codec of blob.hpp and parsing and printing blobs
+// (typed binary arrays) via serialize.hpp.
+#include "serialize.hpp"
+#include <cstdio>
+#include <cstdlib>
+
+struct Tables {
+	std::vector<float> spectrum;
+	std::array<double, 5> lut;
+	std::vector<int> counts; // from i16
+	std::vector<double> widened; // from f32
+	std::vector<float> inlined;
+	std::vector<float> text; // no blob
+};
+
+template<> struct Serializer<Tables> : public PodSerializer<Tables> {
+	template<typename TablesCV>
+	static constexpr auto map(TablesCV& t) {
+		return std::tuple{
+			MapEntry{"spectrum", t.spectrum, true},
+			MapEntry{"lut", t.lut, true},
+			MapEntry{"counts", t.counts, true},
+			MapEntry{"widened", t.widened, true},
+			MapEntry{"inlined", t.inlined, true},
+			MapEntry{"text", t.text, true},
+		};
+	}
+};
+
+constexpr auto document = std::string_view(R"(spectrum:
+	@f32/3 AACAPwAAAEAAAEBA
+lut:
+	@f64/5 AAAAAAAA+D8AAAAAAAAAQAAAAAAAAAhAAAAAAAAAEEAAAAAAAAAUQA==
+counts:
+	@i16/4 AQD+/wMALAE=
+widened:
+	@f32/3 AACAPwAAAEAAAEBA
+inlined: @f32/3 AACAPwAAAEAAAEBA
+text:
+	1
+	2
+)");
+
+bool check(const Tables& t) {
+	return t.spectrum == std::vector{1.f, 2.f, 3.f} &&
+		t.lut == std::array{1.5, 2.0, 3.0, 4.0, 5.0} &&
+		t.counts == std::vector{1, -2, 3, 300} &&
+		t.widened == std::vector{1.0, 2.0, 3.0} &&
+		t.inlined == std::vector{1.f, 2.f, 3.f} &&
+		t.text == std::vector{1.f, 2.f};
+}
+
+// Decodes the items, printed as blob of S, into T. Returns whether
+// decodeBlob accepted them, the items are written to 'out'.
+template<typename T, typename S>
+bool converts(const std::vector<S>& items, std::vector<T>& out) {
+	std::string str;
+	printBlob(str, items.data(), items.size());
+	auto blob = parseBlob(str);
+	out.resize(items.size());
+	return blob && decodeBlob(*blob, out.data());
+}
+
+template<typename T, typename S>
+bool converts(const std::vector<S>& items) {
+	std::vector<T> out;
+	return converts(items, out);
+}
+
+// Items that don't fit into the target type are rejected instead of
+// wrapping around (integers) or being undefined behavior (floats).
+bool checkConversions() {
+	constexpr auto inf = std::numeric_limits<double>::infinity();
+	constexpr auto nan = std::numeric_limits<double>::quiet_NaN();
+	constexpr auto i64min = std::numeric_limits<std::int64_t>::min();
+	std::vector<std::int32_t> truncated;
+	std::vector<float> narrowed;
+
+	return converts<std::uint8_t>(std::vector<std::int64_t>{0, 255}) &&
+		!converts<std::uint8_t>(std::vector<std::int64_t>{1, 256}) &&
+		!converts<std::uint32_t>(std::vector<std::int16_t>{-1}) &&
+		!converts<std::int32_t>(std::vector<std::uint32_t>{4000000000u}) &&
+		converts<std::int64_t>(std::vector<std::uint64_t>{(1ull << 63u) - 1u}) &&
+		!converts<std::int64_t>(std::vector<std::uint64_t>{1ull << 63u}) &&
+		converts<std::int64_t>(std::vector<std::int8_t>{-128, 127}) &&
+		converts<std::int32_t>(std::vector<double>{-2147483648.0, 3.7}, truncated) &&
+		truncated[1] == 3 &&
+		!converts<std::int32_t>(std::vector<double>{2147483648.0}) &&
+		!converts<std::int64_t>(std::vector<double>{nan}) &&
+		!converts<std::int64_t>(std::vector<double>{inf}) &&
+		converts<std::int64_t>(std::vector<double>{double(i64min)}) &&
+		!converts<std::int64_t>(std::vector<double>{-double(i64min)}) &&
+		!converts<std::uint16_t>(std::vector<float>{-1.5f}) &&
+		converts<float>(std::vector<double>{inf, -inf, 1e38}, narrowed) &&
+		narrowed[0] == float(inf) &&
+		!converts<float>(std::vector<double>{1e300}) &&
+		converts<double>(std::vector<std::uint64_t>{~0ull});
+}
+
+bool checkBase64() {
+	unsigned char bytes[64];
+	for(auto i = 0u; i < sizeof(bytes); ++i) {
+		bytes[i] = (i * 97u + 13u) & 0xFFu;
+	}
+
+	for(auto size = 0u; size <= sizeof(bytes); ++size) {
+		std::string encoded;
+		encodeBase64(bytes, size, encoded);
+
+		unsigned char decoded[64];
+		if(!decodeBase64(encoded, decoded, size) ||
+				std::memcmp(bytes, decoded, size) != 0) {
+			std::printf("base64 roundtrip failed for %u bytes\n", size);
+			return false;
+		}
+	}
+
+	unsigned char out[3];
+	return !decodeBase64("AA!A", out, 3) && !decodeBase64("AAA=", out, 1) &&
+		!decodeBase64("AA==", out, 2) && !decodeBase64("AAAA", out, 2);
+}
+
+template<typename T>
+bool fails(std::string_view input) {
+	Parser parser{input};
+	return std::holds_alternative<ErrorType>(parse<T>(parser));
+}
+
+int main() {
+	if(!checkBase64()) {
+		return EXIT_FAILURE;
+	}
+
+	if(!checkConversions()) {
+		std::printf("lossy blob conversion accepted\n");
+		return EXIT_FAILURE;
+	}
+
+	Parser parser{document};
+	auto res = parse<Tables>(parser);
+	if(auto err = std::get_if<ErrorType>(&res)) {
+		std::printf("error %d at %d:%d\n", int(*err),
+			parser.location.line + 1, parser.location.col + 1);
+		return EXIT_FAILURE;
+	}
+
+	auto& tables = std::get<Tables>(res);
+	if(!check(tables)) {
+		std::printf("Unexpected values\n");
+		return EXIT_FAILURE;
+	}
+
+	Printer printer {};
+	printer.blobs = true;
+	print(printer, std::as_const(tables));
+	printer.out += '\n';
+	std::printf("%s", printer.out.c_str());
+
+	Parser reparser{printer.out};
+	auto res2 = parse<Tables>(reparser);
+	if(auto err = std::get_if<ErrorType>(&res2)) {
+		std::printf("printed: error %d at %d:%d\n", int(*err),
+			reparser.location.line + 1, reparser.location.col + 1);
+		return EXIT_FAILURE;
+	}
+
+	if(!check(std::get<Tables>(res2))) {
+		std::printf("printed: unexpected values\n");
+		return EXIT_FAILURE;
+	}
+
+	if(!fails<std::vector<float>>("@f32/3 AACAPwAAAEAAAEB!\n") || // invalid char
+			!fails<std::vector<float>>("@f32/2 AACAPwAAAEAAAEBA\n") || // wrong size
+			!fails<std::vector<float>>("@f32/3 AACAPwAAAEAAAEBA\n4\n") || // not the only item
+			!fails<std::array<float, 2>>("@f32/3 AACAPwAAAEAAAEBA\n") || // wrong count
+			!fails<std::vector<float>>("@x32/3 AACAPwAAAEAAAEBA\n") || // unknown type
+			// count * 4 overflows to 4 bytes, must not be allocated
+			!fails<std::vector<float>>("@f32/4611686018427387905 AACAPw==\n") ||
+			parseBlob("@u8/18446744073709551615 ") || // base64 size overflows
+			// -2 and 300 don't fit into u8
+			!fails<std::vector<std::uint8_t>>("@i16/4 AQD+/wMALAE=\n")) {
+		std::printf("invalid blob accepted\n");
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
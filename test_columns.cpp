@@ -0,0 +1,190 @@
+// Checks parseColumns/printColumns (ColumnSerializer) of serialize.hpp:
+// columns must match the records parsed as rows and survive printing
+// and parsing them again.
+#include "serialize.hpp"
+#include <cstdio>
+#include <cstdlib>
+
+struct Scattering {
+	std::array<float, 3> rgb;
+};
+
+struct Record {
+	std::string name;
+	float g;
+	float scaleHeight;
+	Scattering scattering;
+	std::vector<float> values;
+};
+
+template<> struct Serializer<Record> : public PodSerializer<Record> {
+	template<typename RecordCV>
+	static constexpr auto map(RecordCV& r) {
+		return std::tuple{
+			MapEntry{"name", r.name, true},
+			MapEntry{"g", r.g, false},
+			MapEntry{"scale_height", r.scaleHeight, true},
+			MapEntry{"scattering.rgb", r.scattering.rgb, true},
+			MapEntry{"values", r.values, true},
+		};
+	}
+};
+
+struct RecordColumns {
+	std::vector<std::string> name;
+	std::vector<float> g;
+	std::vector<float> scaleHeight;
+	std::vector<std::array<float, 3>> rgb;
+	std::vector<std::vector<float>> values;
+};
+
+template<> struct Serializer<RecordColumns> : public ColumnSerializer<RecordColumns> {
+	template<typename ColumnsCV>
+	static constexpr auto map(ColumnsCV& c) {
+		return std::tuple{
+			ColumnEntry{"name", c.name, true},
+			ColumnEntry{"g", c.g, false},
+			ColumnEntry{"scale_height", c.scaleHeight, true},
+			ColumnEntry{"scattering.rgb", c.rgb, true},
+			ColumnEntry{"values", c.values, true},
+		};
+	}
+};
+
+// Scattering parameters like in tests/atmosphere.qwe, as array of
+// records. The second record has no 'g'.
+constexpr auto document = std::string_view(R"(# atmosphere layers
+-
+	name: mie
+	g: 0.8
+	scale_height: 1200
+	scattering:
+		rgb:
+			3.996e-6
+			3.996e-6
+			3.996e-6
+	values:
+		1.5
+		2.25
+
+-
+	name: rayleigh
+	scale_height: 8000
+	scattering:
+		rgb:
+			5.802e-6
+			13.558e-6
+			33.1e-6
+	values:
+		0.5
+-
+	# comments and blank lines inside records are fine
+
+	values:
+		1
+		2
+		3
+	scattering:
+		rgb:
+			0
+			1
+			2
+	scale_height: 10
+	name: reordered
+)");
+
+template<typename T>
+std::optional<T> parseDocument(std::string_view input) {
+	Parser parser{input};
+	auto res = parse<T>(parser);
+	if(auto err = std::get_if<ErrorType>(&res)) {
+		std::printf("error %d at %d:%d\n", int(*err),
+			parser.location.line + 1, parser.location.col + 1);
+		return std::nullopt;
+	}
+
+	return std::get<T>(std::move(res));
+}
+
+bool matches(const RecordColumns& cols, const std::vector<Record>& rows) {
+	auto n = rows.size();
+	if(cols.name.size() != n || cols.g.size() != n ||
+			cols.scaleHeight.size() != n || cols.rgb.size() != n ||
+			cols.values.size() != n) {
+		return false;
+	}
+
+	for(auto i = 0u; i < n; ++i) {
+		auto& r = rows[i];
+		if(cols.name[i] != r.name || cols.g[i] != r.g ||
+				cols.scaleHeight[i] != r.scaleHeight ||
+				cols.rgb[i] != r.scattering.rgb || cols.values[i] != r.values) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+template<typename T>
+ErrorType parseError(std::string_view input) {
+	Parser parser{input};
+	auto res = parse<T>(parser);
+	auto err = std::get_if<ErrorType>(&res);
+	return err ? *err : ErrorType::none;
+}
+
+int main() {
+	auto rows = parseDocument<std::vector<Record>>(document);
+	auto cols = parseDocument<RecordColumns>(document);
+	if(!rows || !cols || rows->size() != 3u) {
+		return EXIT_FAILURE;
+	}
+
+	if(!matches(*cols, *rows) || cols->g[1] != 0.f ||
+			cols->values[2] != std::vector{1.f, 2.f, 3.f}) {
+		std::printf("columns don't match the rows\n");
+		return EXIT_FAILURE;
+	}
+
+	Printer printer {};
+	print(printer, std::as_const(*cols));
+	printer.out += '\n';
+
+	auto reparsed = parseDocument<RecordColumns>(printer.out);
+	auto reparsedRows = parseDocument<std::vector<Record>>(printer.out);
+	if(!reparsed || !reparsedRows || !matches(*reparsed, *rows) ||
+			!matches(*reparsed, *reparsedRows)) {
+		std::printf("printed columns differ:\n%s", printer.out.c_str());
+		return EXIT_FAILURE;
+	}
+
+	// columns of different lengths are printed up to the shortest
+	auto uneven = *cols;
+	uneven.name.push_back("extra");
+	uneven.values.pop_back();
+	Printer unevenPrinter {};
+	print(unevenPrinter, std::as_const(uneven));
+	unevenPrinter.out += '\n';
+	auto unevenRows = parseDocument<std::vector<Record>>(unevenPrinter.out);
+	if(!unevenRows || unevenRows->size() != 2u || (*unevenRows)[1].name != "rayleigh") {
+		std::printf("uneven columns: unexpected rows\n");
+		return EXIT_FAILURE;
+	}
+
+	// empty array, no columns
+	auto empty = parseDocument<RecordColumns>("");
+	if(!empty || !empty->name.empty()) {
+		std::printf("empty document failed\n");
+		return EXIT_FAILURE;
+	}
+
+	if(parseError<RecordColumns>("-\n\tname: x\n\tvalues:\n\t\t1\n") !=
+				ErrorType::podMissingField ||
+			parseError<RecordColumns>("name: x\n") != ErrorType::podNonTableEntry) {
+		std::printf("invalid records accepted\n");
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
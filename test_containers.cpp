@@ -0,0 +1,132 @@
+// Parses a document into maps, optionals and pairs via serialize.hpp,
+// prints it and checks that parsing the output gives the same values.
+#include "serialize.hpp"
+#include <cstdio>
+#include <cstdlib>
+
+struct Server {
+	std::string host;
+	int port;
+	std::optional<int> timeout;
+	std::vector<std::pair<int, int>> ranges;
+
+	bool operator==(const Server& o) const {
+		return host == o.host && port == o.port && timeout == o.timeout &&
+			ranges == o.ranges;
+	}
+};
+
+struct Config {
+	std::unordered_map<std::string, Server> servers;
+	std::map<std::string, std::vector<int>> groups;
+	std::optional<std::string> comment;
+	std::optional<int> missing;
+	std::pair<float, std::string> scale;
+	std::vector<std::optional<int>> optionals;
+};
+
+template<> struct Serializer<Server> : public PodSerializer<Server> {
+	template<typename ServerCV>
+	static constexpr auto map(ServerCV& server) {
+		return std::tuple{
+			MapEntry{"host", server.host, true},
+			MapEntry{"port", server.port, true},
+			MapEntry{"timeout", server.timeout},
+			MapEntry{"ranges", server.ranges},
+		};
+	}
+};
+
+template<> struct Serializer<Config> : public PodSerializer<Config> {
+	template<typename ConfigCV>
+	static constexpr auto map(ConfigCV& config) {
+		return std::tuple{
+			MapEntry{"servers", config.servers, true},
+			MapEntry{"groups", config.groups},
+			MapEntry{"comment", config.comment},
+			MapEntry{"missing", config.missing},
+			MapEntry{"scale", config.scale},
+			MapEntry{"optionals", config.optionals},
+		};
+	}
+};
+
+constexpr auto document = std::string_view(R"(servers:
+	alpha:
+		host: alpha.example.com
+		port: 8080
+		ranges:
+			-
+				1
+				10
+			-
+				20
+				30
+	beta:
+		# no timeout, no ranges
+		host: beta.example.com
+		port: 9090
+		timeout: 30
+groups:
+	b:
+		3
+		4
+	a:
+		1
+comment: some comment
+scale:
+	2.5
+	meters
+optionals:
+	1
+	2
+)");
+
+bool check(const Config& c) {
+	auto* alpha = &c.servers.at("alpha");
+	auto* beta = &c.servers.at("beta");
+	return c.servers.size() == 2u &&
+		alpha->host == "alpha.example.com" && alpha->port == 8080 &&
+		!alpha->timeout && alpha->ranges.size() == 2u &&
+		alpha->ranges[1] == std::pair{20, 30} &&
+		beta->timeout == 30 && beta->ranges.empty() &&
+		c.groups.size() == 2u && c.groups.at("b") == std::vector{3, 4} &&
+		c.comment == "some comment" && !c.missing &&
+		c.scale.first == 2.5f && c.scale.second == "meters" &&
+		c.optionals.size() == 2u && c.optionals[1] == 2;
+}
+
+int main() {
+	Parser parser{document};
+	auto res = parse<Config>(parser);
+	if(auto err = std::get_if<ErrorType>(&res)) {
+		std::printf("error %d at %d:%d\n", int(*err),
+			parser.location.line + 1, parser.location.col + 1);
+		return EXIT_FAILURE;
+	}
+
+	auto& config = std::get<Config>(res);
+	if(!check(config)) {
+		std::printf("Unexpected values\n");
+		return EXIT_FAILURE;
+	}
+
+	auto printed = print(config);
+	printed += '\n';
+	std::printf("%s", printed.c_str());
+
+	Parser reparser{printed};
+	auto res2 = parse<Config>(reparser);
+	if(auto err = std::get_if<ErrorType>(&res2)) {
+		std::printf("printed: error %d at %d:%d\n", int(*err),
+			reparser.location.line + 1, reparser.location.col + 1);
+		return EXIT_FAILURE;
+	}
+
+	if(!check(std::get<Config>(res2))) {
+		std::printf("printed: unexpected values\n");
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
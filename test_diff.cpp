@@ -0,0 +1,71 @@
+// Diffs two documents, prints the patch, applies it (after printing
+// and parsing it again) to the first one and checks that the result
+// matches the second one.
+// Usage: test_diff <from> <to>
+#include "s2/diff.hpp"
+#include "s2/parse.hpp"
+#include "s2/print.hpp"
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+std::string readFile(std::string_view filename) {
+	auto openmode = std::ios::ate;
+	std::ifstream ifs(std::string{filename}, openmode);
+	ifs.exceptions(std::ostream::failbit | std::ostream::badbit);
+
+	auto size = ifs.tellg();
+	ifs.seekg(0, std::ios::beg);
+
+	std::string buffer;
+	buffer.resize(size);
+	auto data = reinterpret_cast<char*>(buffer.data());
+	ifs.read(data, size);
+
+	return buffer;
+}
+
+bool parseFile(const char* filename, Table& table) {
+	auto content = readFile(filename);
+	Parser parser{content};
+	Error error;
+	table = parseTable(parser, error);
+	if(error.type != ErrorType::none) {
+		std::printf("%s: error %d at %d:%d\n", filename, int(error.type),
+			error.location.line + 1, error.location.col + 1);
+		return false;
+	}
+
+	return true;
+}
+
+int main(int argc, const char** argv) {
+	if(argc < 3) {
+		std::printf("Usage: test_diff <from> <to>\n");
+		return EXIT_FAILURE;
+	}
+
+	Table from, to;
+	if(!parseFile(argv[1], from) || !parseFile(argv[2], to)) {
+		return EXIT_FAILURE;
+	}
+
+	auto printed = print(toTable(diff(from, to)));
+	std::printf("%s", printed.c_str());
+
+	Parser parser{printed};
+	Error error;
+	auto patch = fromTable(parseTable(parser, error));
+	if(error.type != ErrorType::none || !patch) {
+		std::printf("Invalid patch\n");
+		return EXIT_FAILURE;
+	}
+
+	if(!applyPatch(from, *patch) || fingerprint(from) != fingerprint(to)) {
+		std::printf("Applying the patch failed\n");
+		return EXIT_FAILURE;
+	}
+
+	std::printf("# %zu edits, %zu bytes\n", patch->size(), printed.size());
+	return EXIT_SUCCESS;
+}
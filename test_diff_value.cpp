@@ -0,0 +1,107 @@
+// Checks diff.hpp on Values of data.hpp: for pairs of documents the patch
+// (printed and parsed again via toValue/fromValue) must transform the
+// first into the second. See test_diff.cpp for s2/diff.hpp.
+// Usage: test_diff_value [<from> <to>], defaults to built-in pairs.
+#include "diff.hpp"
+#include "parse.hpp"
+#include "print.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+std::optional<Value> parseDocument(std::string_view input, bool numeric = false) {
+	Parser parser{input};
+	parser.numericArrays = numeric;
+	auto res = parseTableOrArray(parser);
+	if(auto* err = std::get_if<Error>(&res)) {
+		std::printf("error %d at %d:%d\n", int(err->type),
+			err->location.line + 1, err->location.col + 1);
+		return std::nullopt;
+	}
+
+	return std::move(std::get<NamedValue>(res).value);
+}
+
+// Whether patch(from, diff(from, to)) == to, with the patch printed and
+// parsed in between.
+bool roundtrip(std::string_view fromText, std::string_view toText,
+		bool numeric = false) {
+	auto from = parseDocument(fromText, numeric);
+	auto to = parseDocument(toText, numeric);
+	if(!from || !to) {
+		return false;
+	}
+
+	auto patch = diff(*from, *to);
+	if(fingerprint(*from) == fingerprint(*to)) {
+		return patch.empty();
+	}
+
+	auto printed = print(toValue(patch));
+	auto parsed = parseDocument(printed, numeric);
+	auto reparsed = parsed ? fromValue(*parsed) : std::nullopt;
+	if(!reparsed || reparsed->size() != patch.size()) {
+		std::printf("invalid patch:\n%s\n", printed.c_str());
+		return false;
+	}
+
+	if(!applyPatch(*from, *reparsed) || fingerprint(*from) != fingerprint(*to)) {
+		std::printf("applying the patch failed:\n%s\n", printed.c_str());
+		return false;
+	}
+
+	return true;
+}
+
+std::string readFile(const char* filename) {
+	std::ifstream ifs(filename);
+	std::stringstream ss;
+	ss << ifs.rdbuf();
+	return ss.str();
+}
+
+int main(int argc, const char** argv) {
+	if(argc > 2) {
+		return roundtrip(readFile(argv[1]), readFile(argv[2])) ?
+			EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
+	const std::vector<std::pair<const char*, const char*>> pairs = {
+		// identical
+		{"a: 1\nb:\n\tc: 2\n", "b:\n\tc: 2\na: 1\n"},
+		// changed, removed and inserted keys, nested
+		{"a: 1\nb:\n\tc: 2\n\td: 3\ne: 4\n", "a: 5\nb:\n\tc: 2\n\tf: 6\ng: 7\n"},
+		// keys that need escaping in paths
+		{"x.y: 1\nz:\n\tu.v: 2\n", "x.y: 3\nz:\n\tu.v: 4\n\tw: 5\n"},
+		// vectors: insert, remove, change and move items
+		{"v:\n\ta\n\tb\n\tc\n\td\n\te\n", "v:\n\tx\n\ta\n\tc\n\td2\n\te\n\tb\n"},
+		{"v:\n\ta\n\tb\n", "v:\n\tb\n\ta\n\ta\n"},
+		// vectors of tables, changes inside items
+		{"-\n\tname: a\n\tv: 1\n-\n\tname: b\n\tv: 2\n",
+			"-\n\tname: a\n\tv: 3\n-\n\tname: c\n\tv: 2\n-\n\tname: b\n\tv: 2\n"},
+		// type changes
+		{"a: 1\nb:\n\tc: 2\n", "a:\n\tx: 1\nb:\n\t1\n\t2\n"},
+		// root replaced
+		{"a: 1\n", "1\n2\n"},
+	};
+
+	auto ok = true;
+	for(auto [from, to] : pairs) {
+		if(!roundtrip(from, to) || !roundtrip(to, from)) {
+			std::printf("failed: '%s' -> '%s'\n", from, to);
+			ok = false;
+		}
+	}
+
+	// numeric arrays (see Parser::numericArrays) are replaced as a whole
+	if(!roundtrip("v:\n\t1\n\t2\nw:\n\t1.5\n", "v:\n\t1\n\t3\nw:\n\t1.5\n\t2.5\n", true)) {
+		std::printf("failed: numeric arrays\n");
+		ok = false;
+	}
+
+	return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,93 @@
+// Checks that TableHasher of s2/fingerprint.hpp computes the fingerprint
+// of the table while parsing with s2/parse2.hpp, i.e. that it equals
+// fingerprint() of the table built from the same parse. For documents
+// without escapes that table is the one s2/parse.hpp returns (the two
+// parsers can't be used in the same file).
+// Usage: test_fingerprint_s2 [files...], defaults to the s2 documents
+// in tests/ without escapes.
+#include "s2/parse2.hpp"
+#include "s2/fingerprint.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// parse2 handler building the table and hashing it at the same time.
+struct Builder {
+	TableHasher hasher;
+	std::vector<Table*> nest;
+
+	Builder* enterTable(Parser& parser, std::string_view name) {
+		hasher.enterTable(parser, name);
+		auto& entry = nest.back()->emplace_back(std::string(name), Table{});
+		nest.push_back(&entry.second);
+		return this;
+	}
+
+	void exitTable(Parser& parser) {
+		hasher.exitTable(parser);
+		nest.pop_back();
+	}
+
+	void entry(Parser& parser, std::string_view value) {
+		hasher.entry(parser, value);
+		nest.back()->emplace_back(std::string(value), Table{});
+	}
+};
+
+bool check(const std::string& name, std::string_view input) {
+	Table table;
+	Builder builder {{}, {&table}};
+	Parser parser{input};
+	Error error;
+	parseTable(builder, parser, error);
+	if(error.type != ErrorType::none) {
+		std::printf("%s: error %d at %d:%d\n", name.c_str(), int(error.type),
+			error.location.line + 1, error.location.col + 1);
+		return false;
+	}
+
+	if(builder.hasher.result() != fingerprint(table) ||
+			builder.hasher.result() != hashTree(table).table) {
+		std::printf("%s: fingerprints differ\n", name.c_str());
+		return false;
+	}
+
+	return true;
+}
+
+int main(int argc, const char** argv) {
+	std::vector<std::string> files(argv + 1, argv + argc);
+	if(files.empty()) {
+		files = {"tests/atmosphere.qwe", "tests/simple.qwe",
+			"tests/simpleTable.qwe", "tests/tables.qwe"};
+	}
+
+	auto ok = true;
+	for(auto& file : files) {
+		std::ifstream ifs(file);
+		std::stringstream ss;
+		ss << ifs.rdbuf();
+		ok &= check(file, ss.str());
+	}
+
+	// nesting deeper than any fixed bound of the hasher
+	std::string deep;
+	for(auto i = 0u; i < 200u; ++i) {
+		deep += std::string(i, '\t') + "t:\n";
+	}
+	deep += std::string(200u, '\t') + "leaf\n";
+
+	ok &= check("deep", deep);
+	ok &= check("empty", "");
+	ok &= check("inline", "a: b\nc\nd:\n\te: f\n\tg\n");
+
+	// different documents must differ
+	Table a {{{"a", {}}}};
+	Table b {{{"b", {}}}};
+	ok &= fingerprint(a) != fingerprint(b) && fingerprint(a) != fingerprint(Table{});
+
+	return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
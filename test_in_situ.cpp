@@ -0,0 +1,133 @@
+// Checks the in-situ mode of parse.h: the values must equal the ones of
+// a normal parse, point into the input buffer and be destroyed without
+// freeing them. Best run with -fsanitize=address.
+#include "parse.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+constexpr auto document =
+	"# scattering\n"
+	"mie:\n"
+	"\tg: 0.8\n"
+	"\tscattering:\n"
+	"\t\t3.996e-6\n"
+	"\t\t4.5e-6\n"
+	"\n"
+	"rayleigh:\n"
+	"\tscattering:\n"
+	"\t\trgb:\n"
+	"\t\t\t5.802e-6\n"
+	"\t\t\t13.558e-6\n"
+	"\tscale_height: 8000\n"
+	"top: 6420000"; // no newline at the end
+
+bool inside(const char* str, const std::string& buffer) {
+	return str >= buffer.data() && str < buffer.data() + buffer.size();
+}
+
+// Whether both values are equal, and all strings (and names if 'names')
+// of 'situ' point into 'buffer'.
+bool equal(const struct value& val, const struct value& situ,
+		const std::string& buffer, bool names) {
+	if(val.type != situ.type) {
+		return false;
+	}
+
+	switch(val.type) {
+		case value_type_string:
+			return !std::strcmp(val.string, situ.string) &&
+				inside(situ.string, buffer);
+		case value_type_vector:
+			if(val.vector.n_values != situ.vector.n_values) {
+				return false;
+			}
+
+			for(auto i = 0u; i < val.vector.n_values; ++i) {
+				if(!equal(val.vector.values[i], situ.vector.values[i], buffer, names)) {
+					return false;
+				}
+			}
+
+			return true;
+		case value_type_table:
+			if(val.table.n_entries != situ.table.n_entries) {
+				return false;
+			}
+
+			for(auto i = 0u; i < val.table.n_entries; ++i) {
+				auto& a = val.table.entries[i];
+				auto& b = situ.table.entries[i];
+				if(std::strcmp(a.name, b.name) || inside(b.name, buffer) != names ||
+						!equal(a.value, b.value, buffer, names)) {
+					return false;
+				}
+			}
+
+			return true;
+	}
+
+	return false;
+}
+
+struct parse_result parse(const char* input, bool inSitu,
+		struct atom_table* atoms = nullptr) {
+	struct parser parser {};
+	parser.input = input;
+	parser.in_situ = inSitu;
+	parser.atoms = atoms;
+	auto res = parse_table_or_array(&parser);
+	std::free(parser.location.nest_tables);
+	return res;
+}
+
+int main() {
+	auto ok = true;
+	auto res = parse(document, false);
+	if(!res.success || res.value.value.type != value_type_table) {
+		std::printf("parse failed\n");
+		return EXIT_FAILURE;
+	}
+
+	// names and strings point into the buffer
+	std::string buffer = document;
+	auto situ = parse(buffer.c_str(), true);
+	if(!situ.success || !equal(res.value.value, situ.value.value, buffer, true) ||
+			!(situ.value.value.flags & value_flags_borrowed_strings)) {
+		std::printf("in situ: values differ\n");
+		ok = false;
+	}
+
+	// must not free anything inside the buffer
+	if(situ.success) {
+		destroy_value(&situ.value.value);
+	}
+
+	// with atoms, only the strings point into the buffer
+	buffer = document;
+	struct atom_table atoms {};
+	auto situAtoms = parse(buffer.c_str(), true, &atoms);
+	if(!situAtoms.success ||
+			!equal(res.value.value, situAtoms.value.value, buffer, false)) {
+		std::printf("in situ with atoms: values differ\n");
+		ok = false;
+	}
+
+	if(situAtoms.success) {
+		destroy_value(&situAtoms.value.value);
+	}
+
+	atom_table_destroy(&atoms);
+
+	// errors must not free anything inside the buffer either
+	buffer = "a: 1\nb:\n\tc\n\td: 2\n";
+	auto err = parse(buffer.c_str(), true);
+	if(err.success || err.error.type != error_type_mixed_table_array) {
+		std::printf("in situ: mixed table accepted\n");
+		ok = false;
+	}
+
+	destroy_value(&res.value.value);
+	return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
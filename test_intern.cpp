@@ -0,0 +1,149 @@
+// Checks the interning tables of intern.hpp and intern.h and their use
+// in s2/atoms.hpp and parse.h. Best run with -fsanitize=address to
+// detect wrongly freed (interned) names.
+#include "s2/atoms.hpp"
+#include "parse.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+bool checkAtomTable() {
+	AtomTable atoms;
+	auto a = atoms.intern("a");
+	auto b = atoms.intern(std::string("b"));
+	auto* aStr = a.str;
+
+	// many more strings, the first ones must stay valid
+	for(auto i = 0u; i < 10000u; ++i) {
+		atoms.intern(std::to_string(i));
+	}
+
+	auto a2 = atoms.intern(std::string("a"));
+	return a == a2 && a.str == a2.str && a.str == aStr && a != b &&
+		a.view() == "a" && atoms.find("b") == b && !atoms.find("c") &&
+		atoms.size() == 10002u;
+}
+
+bool checkATable() {
+	std::string doc =
+		"records:\n"
+		"\tr:\n\t\tname: x\n\t\tvalue: 1\n"
+		"\tr:\n\t\tname: y\n\t\tvalue: 2\n"
+		"flags:\n\tfast\n\tsafe\n";
+
+	AtomTable atoms;
+	Parser parser{doc};
+	Error error;
+	auto table = parseATable(atoms, parser, error);
+	if(error.type != ErrorType::none) {
+		return false;
+	}
+
+	// only table names are interned, not the values
+	if(atoms.size() != 5u || atoms.find("x") || atoms.find("fast")) {
+		std::printf("atoms: values were interned\n");
+		return false;
+	}
+
+	auto* records = find(atoms, table, "records");
+	auto* flags = find(atoms, table, "flags");
+	if(!records || records->size() != 2u || !flags || flags->size() != 2u) {
+		return false;
+	}
+
+	auto& r0 = (*records)[0].table;
+	auto& r1 = (*records)[1].table;
+	auto* name0 = find(atoms, r0, "name");
+	auto* name1 = find(atoms, r1, "name");
+	if(!name0 || !name1 || r0[0].name.str != r1[0].name.str ||
+			(*name0)[0].key() != "x" || (*name1)[0].key() != "y" ||
+			(*name1)[0].name) {
+		std::printf("atoms: unexpected records\n");
+		return false;
+	}
+
+	return find(atoms, *flags, "safe") && !find(atoms, *flags, "slow") &&
+		!find(atoms, table, "fast");
+}
+
+// Nesting deeper than any fixed bound the builder might have.
+bool checkDeepATable() {
+	constexpr auto depth = 200u;
+	std::string doc;
+	for(auto i = 0u; i < depth; ++i) {
+		doc += std::string(i, '\t') + "t:\n";
+	}
+	doc += std::string(depth, '\t') + "leaf\n";
+
+	AtomTable atoms;
+	Parser parser{doc};
+	Error error;
+	auto table = parseATable(atoms, parser, error);
+
+	const ATable* current = &table;
+	for(auto i = 0u; i < depth && current; ++i) {
+		current = find(atoms, *current, "t");
+	}
+
+	return error.type == ErrorType::none && current && current->size() == 1u &&
+		(*current)[0].key() == "leaf";
+}
+
+// parse.h with parser.atoms, the values don't own the names.
+bool checkParseAtoms() {
+	const char* doc = "a:\n\tname: x\nb:\n\tname: y\n";
+
+	struct atom_table atoms {};
+	struct parser parser {};
+	parser.input = doc;
+	parser.atoms = &atoms;
+	auto res = parse_table_or_array(&parser);
+	std::free(parser.location.nest_tables);
+	if(!res.success || res.value.value.type != value_type_table) {
+		return false;
+	}
+
+	auto& root = res.value.value.table;
+	auto ok = root.n_entries == 2u && atoms.n_atoms == 3u &&
+		root.entries[0].value.table.entries[0].name ==
+		root.entries[1].value.table.entries[0].name &&
+		!std::strcmp(root.entries[1].value.table.entries[0].value.string, "y");
+	destroy_value(&res.value.value);
+
+	// duplicates are detected by comparing the interned pointers
+	struct parser dup {};
+	dup.input = "name: 1\nname: 2\n";
+	dup.atoms = &atoms;
+	res = parse_table_or_array(&dup);
+	std::free(dup.location.nest_tables);
+	ok &= !res.success && res.error.type == error_type_duplicate_name;
+
+	atom_table_destroy(&atoms);
+	return ok;
+}
+
+int main() {
+	auto ok = true;
+	if(!checkAtomTable()) {
+		std::printf("AtomTable failed\n");
+		ok = false;
+	}
+
+	if(!checkATable()) {
+		std::printf("parseATable failed\n");
+		ok = false;
+	}
+
+	if(!checkDeepATable()) {
+		std::printf("parseATable failed for deep nesting\n");
+		ok = false;
+	}
+
+	if(!checkParseAtoms()) {
+		std::printf("parse.h with atoms failed\n");
+		ok = false;
+	}
+
+	return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,92 @@
+// Checks loadFiles/listFiles of load.hpp on a temporary directory of
+// plain and gzip compressed files, including errors.
+// Build with -DLOAD_ZLIB -lz.
+#include "load.hpp"
+#include "parse.hpp"
+#include "util.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <zlib.h>
+
+namespace fs = std::filesystem;
+
+void writePlain(const fs::path& path, const std::string& content) {
+	std::ofstream(path, std::ios::binary) << content;
+}
+
+void writeGzip(const fs::path& path, const std::string& content) {
+	auto file = gzopen(path.string().c_str(), "wb");
+	gzwrite(file, content.data(), unsigned(content.size()));
+	gzclose(file);
+}
+
+// The value of 'id' in the file, throws an int for "throw".
+std::string parseId(std::string_view content) {
+	Parser parser{content};
+	auto res = parseTableOrArray(parser);
+	if(std::holds_alternative<Error>(res)) {
+		throw std::runtime_error("Parse error");
+	}
+
+	auto& value = std::get<NamedValue>(res).value;
+	auto* id = at(value, "id");
+	auto* str = id ? asString(*id) : nullptr;
+	if(str && *str == "throw") {
+		throw 42;
+	}
+
+	return str ? *str : std::string();
+}
+
+int main() {
+	auto dir = fs::temp_directory_path() / "qwe_test_load";
+	fs::remove_all(dir);
+	fs::create_directories(dir / "sub");
+
+	// big enough for several read chunks and inflate calls
+	std::string big = "id: big\nvalues:\n";
+	for(auto i = 0u; i < 20000u; ++i) {
+		big += "\t" + std::to_string(i) + "\n";
+	}
+
+	writePlain(dir / "a.qwe", "id: a\n");
+	writeGzip(dir / "b.qwe", "id: b\n");
+	writePlain(dir / "sub" / "c.qwe", big);
+	writeGzip(dir / "sub" / "d.qwe", big);
+	writePlain(dir / "e.qwe", "id: throw\n");
+	writePlain(dir / "f.qwe", "id\n\t\tbad\n");
+	writePlain(dir / "g.txt", "id: ignored\n");
+
+	auto ok = true;
+	auto files = listFiles(dir.string());
+	if(files.size() != 6u || files[0] != (dir / "a.qwe").string()) {
+		std::printf("listFiles: unexpected files\n");
+		ok = false;
+	}
+
+	if(!listFiles((dir / "missing").string()).empty()) {
+		std::printf("listFiles: missing directory has files\n");
+		ok = false;
+	}
+
+	files.push_back((dir / "missing.qwe").string());
+	for(auto threads : {1u, 3u}) {
+		auto results = loadFiles(files, parseId, threads);
+		const char* expected[] = {"a", "b", nullptr, nullptr, "big", "big", nullptr};
+		for(auto i = 0u; i < results.size(); ++i) {
+			auto& res = results[i];
+			auto good = res.path == files[i] && (expected[i] ?
+				res.value == std::optional<std::string>(expected[i]) :
+				!res.value && !res.error.empty());
+			if(!good) {
+				std::printf("%u threads, %s: unexpected result '%s'\n", threads,
+					res.path.c_str(), res.error.c_str());
+				ok = false;
+			}
+		}
+	}
+
+	fs::remove_all(dir);
+	return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
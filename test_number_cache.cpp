@@ -0,0 +1,110 @@
+// Checks NumberCache of util.hpp: memoized conversions must equal the
+// uncached ones, follow changes of the strings, stay within the
+// capacity and be safe to use from multiple threads.
+#include "util.hpp"
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+int main() {
+	auto ok = true;
+	auto check = [&](bool cond, const char* what) {
+		if(!cond) {
+			std::printf("failed: %s\n", what);
+			ok = false;
+		}
+	};
+
+	// the cache is a side table, values don't pay for it
+	static_assert(sizeof(Value) == sizeof(Value::value));
+
+	NumberCache cache;
+	Value value {std::string("42")};
+	check(as<int>(value, cache) == 42 && as<int>(value, cache) == 42 &&
+		as<double>(value, cache) == 42.0 && cache.size() == 1u, "caching");
+
+	Value text {std::string("abc")};
+	check(!as<int>(text, cache) && !as<float>(text, cache) &&
+		!as<int>(text, cache) && cache.size() <= 2u, "not a number");
+
+	Value fraction {std::string("3.996e-6")};
+	check(as<float>(fraction, cache) == as<float>(fraction) &&
+		as<double>(fraction, cache) == as<double>(fraction) &&
+		as<long double>(fraction, cache) == as<long double>(fraction) &&
+		as<int>(fraction, cache) == 3, "same as uncached");
+
+	// replaced strings, same length and (short string) storage
+	value.value = std::string("43");
+	check(as<int>(value, cache) == 43 && as<double>(value, cache) == 43.0,
+		"replaced string");
+
+	// modified in place
+	(*asString(value))[0] = '5';
+	check(as<int>(value, cache) == 53, "modified string");
+
+	// a change of any char, for all cached lengths
+	auto anyChar = true;
+	for(auto n = 1u; n <= NumberCache::maxText; ++n) {
+		Value digits {std::string(n, '1')};
+		auto& str = *asString(digits);
+		anyChar &= (as<double>(digits, cache) == as<double>(digits));
+		for(auto i = 0u; i < n; ++i) {
+			str[i] = '2';
+			anyChar &= (as<double>(digits, cache) == as<double>(digits));
+			str[i] = '1';
+			anyChar &= (as<double>(digits, cache) == as<double>(digits));
+		}
+	}
+
+	check(anyChar, "modified chars");
+
+	// other types and long strings aren't cached
+	Value vec {Vector{}};
+	Value big {std::string("123456789012345678901234567890")};
+	auto size = cache.size();
+	check(!as<int>(vec, cache) && as<double>(big, cache) == as<double>(big) &&
+		cache.size() == size, "uncached values");
+
+	cache.clear();
+	check(cache.size() == 0u && as<int>(value, cache) == 53, "clear");
+
+	Vector items;
+	for(auto i = 0u; i < 1000u; ++i) {
+		items.push_back(std::make_unique<Value>(Value{std::to_string(i) + ".5"}));
+	}
+
+	// more values than slots evict each other
+	NumberCache small(10u);
+	auto evicted = small.capacity() == 16u;
+	for(auto run = 0u; run < 2u; ++run) {
+		for(auto i = 0u; i < items.size(); ++i) {
+			evicted &= (as<double>(*items[i], small) == i + 0.5);
+		}
+	}
+
+	check(evicted && small.size() <= small.capacity(), "bounded");
+
+	// concurrent readers of a shared cache
+	std::atomic<bool> failed {false};
+	std::vector<std::thread> readers;
+	for(auto t = 0u; t < 4u; ++t) {
+		readers.emplace_back([&]{
+			for(auto run = 0u; run < 10u; ++run) {
+				for(auto i = 0u; i < items.size(); ++i) {
+					if(as<double>(*items[i], cache) != i + 0.5 ||
+							as<int>(*items[i], cache) != int(i)) {
+						failed = true;
+					}
+				}
+			}
+		});
+	}
+
+	for(auto& reader : readers) {
+		reader.join();
+	}
+
+	check(!failed && cache.size() <= cache.capacity(), "concurrent readers");
+	return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
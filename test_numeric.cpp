@@ -0,0 +1,140 @@
+// Checks Parser::numericArrays of parse.hpp: arrays of numbers or with
+// a blob become Integers or Numbers, all others keep their text, and the
+// typed accessors of util.hpp (as<std::vector<T>>, asRange<T>) work on
+// both.
+#include "parse.hpp"
+#include "print.hpp"
+#include "util.hpp"
+#include <cstdio>
+#include <cstdlib>
+
+constexpr auto document = std::string_view(
+	"ints:\n\t1\n\t-2\n\t3\n"
+	"floats:\n\t1.5\n\t2\n\t-3e2\n"
+	"big:\n\t9223372036854775808\n\t1\n" // doesn't fit int64
+	"text_last:\n\t1\n\t2\n\tx\n"
+	"text_first:\n\tinf\n\t1\n"
+	"signed:\n\t+1\n\t2\n"
+	"nested:\n\t1\n\t-\n\t\t2\n\t\t3\n"
+	"table:\n\ta: 1\n\tb: 2\n"
+	"single: 5\n");
+
+std::optional<Value> parseDocument(std::string_view input, bool numeric) {
+	Parser parser{input};
+	parser.numericArrays = numeric;
+	auto res = parseTableOrArray(parser);
+	if(auto* err = std::get_if<Error>(&res)) {
+		std::printf("error %d at %d:%d\n", int(err->type),
+			err->location.line + 1, err->location.col + 1);
+		return std::nullopt;
+	}
+
+	return std::move(std::get<NamedValue>(res).value);
+}
+
+int main() {
+	auto ok = true;
+	auto check = [&](bool cond, const char* what) {
+		if(!cond) {
+			std::printf("failed: %s\n", what);
+			ok = false;
+		}
+	};
+
+	auto numeric = parseDocument(document, true);
+	auto plain = parseDocument(document, false);
+	if(!numeric || !plain) {
+		return EXIT_FAILURE;
+	}
+
+	auto& doc = *numeric;
+	auto* ints = asIntegers(*at(doc, "ints"));
+	auto* floats = asNumbers(*at(doc, "floats"));
+	auto* big = asNumbers(*at(doc, "big"));
+	check(ints && *ints == Integers{1, -2, 3}, "integers");
+	check(floats && *floats == Numbers{1.5, 2.0, -300.0}, "numbers");
+	check(big && big->size() == 2u && (*big)[0] == 9223372036854775808.0,
+		"integer overflow falls back to numbers");
+
+	// mixed arrays keep the text of all their items
+	auto* last = asVector(*at(doc, "text_last"));
+	check(last && last->size() == 3u && *asString(*(*last)[0]) == "1" &&
+		*asString(*(*last)[2]) == "x", "text after numbers");
+	check(asVector(*at(doc, "text_first")) && asVector(*at(doc, "signed")),
+		"non-numbers first");
+	auto* nested = asVector(*at(doc, "nested"));
+	check(nested && nested->size() == 2u && *asString(*(*nested)[0]) == "1" &&
+		asIntegers(*(*nested)[1]), "nested array");
+	check(asTable(*at(doc, "table")) && asString(*at(doc, "single")),
+		"tables and strings unchanged");
+
+	// without the flag, all arrays are vectors of strings
+	check(asVector(*at(*plain, "ints")) && asVector(*at(*plain, "floats")),
+		"flag off");
+
+	// as<std::vector<T>> converts numeric arrays and vectors alike
+	for(auto* value : {&doc, &*plain}) {
+		check(as<std::vector<float>>(*value, "floats") ==
+			std::vector<float>{1.5f, 2.f, -300.f}, "as float vector");
+		check(as<std::vector<int>>(*value, "ints") == std::vector<int>{1, -2, 3},
+			"as int vector");
+		check(!as<std::vector<float>>(*value, "text_last"), "as mixed vector");
+	}
+
+	check(as<std::vector<std::string>>(doc, "ints") ==
+		std::vector<std::string>{"1", "-2", "3"} &&
+		as<std::vector<std::string>>(doc, "floats") ==
+		std::vector<std::string>{"1.5", "2", "-300"}, "as string vector");
+
+	// asRange over numeric arrays
+	auto floatRange = asRange<float>(*at(doc, "floats"));
+	auto intRange = asRange<std::string>(*at(doc, "ints"));
+	check(floatRange && floatRange->size() == 3u && (*floatRange)[2] == -300.f &&
+		intRange && (*intRange)[1] == "-2" && !asRange<float>(*at(doc, "single")),
+		"asRange");
+
+	auto sum = 0.0;
+	auto doubleRange = asRange<double>(*at(doc, "floats"));
+	for(auto item : *doubleRange) {
+		sum += item.value_or(0.0);
+	}
+
+	float out[2] {};
+	check(sum == -296.5 && floatRange->convert(out, 2u, 1u) &&
+		out[0] == 2.f && out[1] == -300.f, "asRange iteration");
+	check(std::count(intRange->begin(), intRange->end(), std::optional<std::string>("3")) == 1,
+		"asRange algorithms");
+
+	// printed numeric arrays parse back to the same numbers
+	auto reparsed = parseDocument(print(doc), true);
+	check(reparsed && *asIntegers(*at(*reparsed, "ints")) == *ints &&
+		*asNumbers(*at(*reparsed, "floats")) == *floats, "print roundtrip");
+
+	// blobs (see blob.hpp) are decoded into numeric arrays, invalid
+	// ones and blobs among other items keep their text
+	auto blobs = parseDocument(
+		"floats:\n\t@f32/3 AACAPwAAAEAAAEBA\n"
+		"inline: @f32/3 AACAPwAAAEAAAEBA\n"
+		"ints:\n\t@i16/4 AQD+/wMALAE=\n"
+		"invalid: @f32/3 AACAPwAAAEAAAEB!\n"
+		"overflow:\n\t@f32/4611686018427387905 AACAPw==\n"
+		"unsigned:\n\t@u64/1 BQAAAAAAAAA=\n"
+		"beyond_int64:\n\t@u64/1 AAAAAAAAAIA=\n"
+		"mixed:\n\t1\n\t@f32/3 AACAPwAAAEAAAEBA\n", true);
+	if(!blobs) {
+		return EXIT_FAILURE;
+	}
+
+	auto* blobFloats = asNumbers(*at(*blobs, "floats"));
+	auto* blobInline = asNumbers(*at(*blobs, "inline"));
+	auto* blobInts = asIntegers(*at(*blobs, "ints"));
+	check(blobFloats && *blobFloats == Numbers{1.0, 2.0, 3.0} &&
+		blobInline && *blobInline == *blobFloats, "f32 blobs");
+	check(blobInts && *blobInts == Integers{1, -2, 3, 300}, "i16 blob");
+	check(asString(*at(*blobs, "invalid")) && asVector(*at(*blobs, "overflow")) &&
+		asVector(*at(*blobs, "mixed"))->size() == 2u, "invalid blobs");
+	check(*asIntegers(*at(*blobs, "unsigned")) == Integers{5} &&
+		asVector(*at(*blobs, "beyond_int64")), "u64 blobs");
+
+	return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
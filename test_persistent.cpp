@@ -0,0 +1,102 @@
+// Checks PValue of persistent.hpp: set, remove, invalid paths and that
+// snapshots are isolated from later updates and share unmodified
+// subtrees. See test_persistent_s2.cpp for the s2 variant.
+#include "persistent.hpp"
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+bool hasString(const PValue& root, std::string_view path, std::string_view str) {
+	auto* value = root.at(path);
+	auto* s = value ? value->asString() : nullptr;
+	return s && *s == str;
+}
+
+PValue makeDocument() {
+	return PValue::table({
+		{"mie", PValue::table({
+			{"g", PValue("0.8")},
+			{"rgb", PValue::vector({PValue("1"), PValue("2"), PValue("3")})},
+		})},
+		{"rayleigh", PValue::table({{"scale_height", PValue("8000")}})},
+		{"top", PValue("6420000")},
+	});
+}
+
+int main() {
+	auto ok = true;
+	auto check = [&](bool cond, const char* what) {
+		if(!cond) {
+			std::printf("failed: %s\n", what);
+			ok = false;
+		}
+	};
+
+	auto v0 = makeDocument();
+	check(hasString(v0, "mie.rgb.1", "2") && !v0.at("mie.rgb.3") &&
+		!v0.at("mie.x") && !v0.at("top.x"), "at");
+
+	// set replaces and inserts, the old version stays unchanged
+	auto v1 = v0.set("mie.g", PValue("0.7"));
+	auto v2 = v1.set("mie.rgb.3", PValue("4")).set("new.a.b", PValue("x"));
+	check(hasString(v0, "mie.g", "0.8") && hasString(v1, "mie.g", "0.7") &&
+		hasString(v2, "mie.g", "0.7"), "set value");
+	check(!v1.at("mie.rgb.3") && hasString(v2, "mie.rgb.3", "4") &&
+		hasString(v2, "new.a.b", "x") && !v0.at("new"), "set append/insert");
+	check(v1.find("rayleigh")->sameAs(*v0.find("rayleigh")) &&
+		v1.at("mie.rgb")->sameAs(*v0.at("mie.rgb")), "unmodified subtrees shared");
+
+	// strings along the path become tables
+	auto v3 = v0.set("top.value", PValue("1"));
+	check(hasString(v3, "top.value", "1") && hasString(v0, "top", "6420000"),
+		"set through string");
+
+	// invalid indices leave the value unchanged
+	check(v0.set("mie.rgb.4", PValue("x")).sameAs(v0) &&
+		v0.set("mie.rgb.one", PValue("x")).sameAs(v0) &&
+		v0.set("mie.rgb.-1", PValue("x")).sameAs(v0) &&
+		v0.set("mie.rgb.7.a", PValue("x")).sameAs(v0), "set invalid index");
+
+	// remove
+	auto v4 = v2.remove("mie.rgb.0").remove("rayleigh");
+	check(hasString(v4, "mie.rgb.0", "2") && v4.asVector() == nullptr &&
+		v4.at("mie.rgb")->asVector()->size() == 3u && !v4.at("rayleigh") &&
+		hasString(v2, "mie.rgb.0", "1") && v2.at("rayleigh"), "remove");
+	check(v0.remove("nothing").sameAs(v0) && v0.remove("mie.rgb.3").sameAs(v0) &&
+		v0.remove("top.x").sameAs(v0), "remove missing");
+
+	// conversions
+	auto roundtrip = makePersistent(toValue(v2));
+	check(hasString(roundtrip, "mie.rgb.3", "4") &&
+		hasString(roundtrip, "new.a.b", "x") &&
+		roundtrip.asTable()->size() == v2.asTable()->size(), "conversion");
+
+	// snapshots can be read while new versions are created
+	std::vector<std::thread> readers;
+	std::atomic<bool> failed {false};
+	for(auto t = 0u; t < 4u; ++t) {
+		readers.emplace_back([&, snapshot = v1]{
+			for(auto i = 0u; i < 10000u; ++i) {
+				if(!hasString(snapshot, "mie.g", "0.7") || snapshot.at("new")) {
+					failed = true;
+				}
+			}
+		});
+	}
+
+	auto current = v1;
+	for(auto i = 0u; i < 1000u; ++i) {
+		current = current.set("mie.g", PValue(std::to_string(i)))
+			.set("new.i", PValue(std::to_string(i)));
+	}
+
+	for(auto& reader : readers) {
+		reader.join();
+	}
+
+	check(!failed && hasString(current, "new.i", "999") &&
+		hasString(v1, "mie.g", "0.7"), "concurrent snapshots");
+
+	return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
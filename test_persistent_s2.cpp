@@ -0,0 +1,95 @@
+// Checks PTable of s2/persistent.hpp: set, remove, append and that
+// snapshots are isolated from later updates and share unmodified
+// subtrees. See test_persistent.cpp for the data.hpp variant.
+#include "s2/persistent.hpp"
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+// Whether the table at 'path' is the s2 string 'str'.
+bool hasString(const PTable& root, std::string_view path, std::string_view str) {
+	auto* table = root.at(path);
+	return table && table->size() == 1u && (*table)[0].first == str &&
+		(*table)[0].second.empty();
+}
+
+PTable makeDocument() {
+	return PTable({
+		{"mie", PTable({
+			{"g", PTable::string("0.8")},
+			{"rgb", PTable({{"1", {}}, {"2", {}}, {"3", {}}})},
+		})},
+		{"rayleigh", PTable({{"scale_height", PTable::string("8000")}})},
+		{"top", PTable::string("6420000")},
+	});
+}
+
+int main() {
+	auto ok = true;
+	auto check = [&](bool cond, const char* what) {
+		if(!cond) {
+			std::printf("failed: %s\n", what);
+			ok = false;
+		}
+	};
+
+	auto v0 = makeDocument();
+	check(hasString(v0, "mie.g", "0.8") && v0.at("mie.rgb.2") &&
+		!v0.at("mie.x") && !v0.at("top.x"), "at");
+
+	// set replaces and appends, the old version stays unchanged
+	auto v1 = v0.set("mie.g", "0.7");
+	auto v2 = v1.set("new.a.b", "x");
+	check(hasString(v0, "mie.g", "0.8") && hasString(v1, "mie.g", "0.7") &&
+		hasString(v2, "mie.g", "0.7"), "set value");
+	check(hasString(v2, "new.a.b", "x") && !v1.at("new") && !v0.at("new") &&
+		v2[v2.size() - 1].first == "new", "set append");
+	check(v1.find("rayleigh")->sameAs(*v0.find("rayleigh")) &&
+		v1.at("mie.rgb")->sameAs(*v0.at("mie.rgb")), "unmodified subtrees shared");
+
+	// append keeps duplicates, find returns the first one
+	auto v3 = v0.append("top", PTable::string("1"));
+	check(v3.size() == v0.size() + 1u && hasString(v3, "top", "6420000") &&
+		v0.size() == 3u, "append");
+
+	// remove
+	auto v4 = v2.remove("mie.rgb.1").remove("rayleigh");
+	check(v4.at("mie.rgb")->size() == 2u && !v4.at("mie.rgb.1") &&
+		!v4.at("rayleigh") && v2.at("mie.rgb.1") && v2.at("rayleigh"), "remove");
+	check(v0.remove("nothing").sameAs(v0) && v0.remove("mie.x").sameAs(v0) &&
+		v0.remove("").sameAs(v0), "remove missing");
+
+	// conversions
+	auto roundtrip = makePersistent(toTable(v2));
+	check(hasString(roundtrip, "new.a.b", "x") && roundtrip.size() == v2.size(),
+		"conversion");
+
+	// snapshots can be read while new versions are created
+	std::vector<std::thread> readers;
+	std::atomic<bool> failed {false};
+	for(auto t = 0u; t < 4u; ++t) {
+		readers.emplace_back([&, snapshot = v1]{
+			for(auto i = 0u; i < 10000u; ++i) {
+				if(!hasString(snapshot, "mie.g", "0.7") || snapshot.at("new")) {
+					failed = true;
+				}
+			}
+		});
+	}
+
+	auto current = v1;
+	for(auto i = 0u; i < 1000u; ++i) {
+		current = current.set("mie.g", std::to_string(i))
+			.set("new.i", std::to_string(i));
+	}
+
+	for(auto& reader : readers) {
+		reader.join();
+	}
+
+	check(!failed && hasString(current, "new.i", "999") &&
+		hasString(v1, "mie.g", "0.7"), "concurrent snapshots");
+
+	return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
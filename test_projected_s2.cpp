@@ -0,0 +1,129 @@
+// Checks that Projected of s2/projection.hpp forwards exactly the leaves
+// of a full parse2.hpp parse that lie on or inside the projected paths,
+// and that it rejects paths deeper than it supports. See
+// test_projection_s2.cpp for s2/parse.hpp.
+// Usage: test_projected_s2 [file], defaults to tests/atmosphere.qwe.
+#include "s2/projection.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using Path = std::vector<std::string>;
+using Leaves = std::vector<Path>; // strings are tables without entries
+
+// Collects the paths of all entries.
+struct Collector {
+	Path nest;
+	Leaves leaves;
+
+	void enterTable(Parser&, std::string_view name) { nest.emplace_back(name); }
+	void exitTable(Parser&) { nest.pop_back(); }
+	void entry(Parser&, std::string_view value) {
+		leaves.push_back(nest);
+		leaves.back().emplace_back(value);
+	}
+};
+
+std::vector<std::string_view> segments(std::string_view path) {
+	std::vector<std::string_view> ret;
+	auto dot = path.find('.');
+	for(; dot != path.npos; dot = path.find('.')) {
+		ret.push_back(path.substr(0, dot));
+		path = path.substr(dot + 1);
+	}
+
+	ret.push_back(path);
+	return ret;
+}
+
+Leaves filter(const Leaves& leaves, const std::vector<std::string_view>& projection) {
+	Leaves ret;
+	for(auto& leaf : leaves) {
+		for(auto proj : projection) {
+			auto segs = segments(proj);
+			if(segs.size() <= leaf.size() &&
+					std::equal(segs.begin(), segs.end(), leaf.begin())) {
+				ret.push_back(leaf);
+				break;
+			}
+		}
+	}
+
+	return ret;
+}
+
+std::optional<Leaves> parseLeaves(std::string_view input,
+		const std::vector<std::string_view>& projection,
+		ErrorType expected = ErrorType::none) {
+	Parser parser{input};
+	Error error;
+	Collector collector;
+	if(projection.empty()) {
+		parseTable(collector, parser, error);
+	} else {
+		parseTable(collector, parser, error, projection.data(), projection.size());
+	}
+
+	if(error.type != expected) {
+		return std::nullopt;
+	}
+
+	std::sort(collector.leaves.begin(), collector.leaves.end());
+	return collector.leaves;
+}
+
+int main(int argc, const char** argv) {
+	auto file = argc > 1 ? argv[1] : "tests/atmosphere.qwe";
+	std::ifstream ifs(file);
+	std::stringstream ss;
+	ss << ifs.rdbuf();
+	auto input = ss.str();
+
+	auto full = parseLeaves(input, {});
+	if(!full || full->empty()) {
+		std::printf("%s: full parse failed\n", file);
+		return EXIT_FAILURE;
+	}
+
+	const std::vector<std::vector<std::string_view>> projections = {
+		{"mie"},
+		{"rayleigh.scattering.rgb", "top"},
+		{"solar_irradiance.spectral", "mie.g"},
+		{"solar_irradiance", "bottom", "min_mu_s"},
+		{"mie.nothing"},
+		{"nothing.here"},
+	};
+
+	auto ok = true;
+	for(auto& projection : projections) {
+		auto leaves = parseLeaves(input, projection);
+		if(!leaves || *leaves != filter(*full, projection)) {
+			std::printf("Projected: wrong values for '%s'\n", projection[0].data());
+			ok = false;
+		}
+	}
+
+	// paths as deep as supported still match, deeper ones are errors
+	constexpr auto maxDepth = 32u;
+	std::string doc, path;
+	for(auto i = 0u; i < maxDepth; ++i) {
+		doc += std::string(i, '\t') + "t:\n";
+		path += i ? ".t" : "t";
+	}
+	doc += std::string(maxDepth, '\t') + "leaf\n";
+
+	auto deep = parseLeaves(doc, {path});
+	auto tooDeep = path + ".leaf";
+	if(!deep || deep->size() != 1u || deep->front().back() != "leaf" ||
+			!parseLeaves(doc, {"x", tooDeep}, ErrorType::projectionTooDeep)) {
+		std::printf("Projected: deep paths failed\n");
+		ok = false;
+	}
+
+	return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
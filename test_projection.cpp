@@ -0,0 +1,146 @@
+// Checks that projected parses of parse.hpp and parse_cb.h yield exactly
+// the values of a full parse that lie on or inside the projected paths.
+// Usage: test_projection [file], defaults to tests/atmosphere.qwe.
+#include "parse.hpp"
+#include "parse_cb.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using Leaves = std::vector<std::pair<std::string, std::string>>; // path, value
+
+bool inside(const std::string& path, std::string_view proj) {
+	return path.compare(0, proj.size(), proj) == 0 &&
+		(path.size() == proj.size() || path[proj.size()] == '.');
+}
+
+bool inside(const std::string& path, const std::vector<std::string_view>& projection) {
+	return std::any_of(projection.begin(), projection.end(),
+		[&](auto proj) { return inside(path, proj); });
+}
+
+Leaves filter(const Leaves& leaves, const std::vector<std::string_view>& projection) {
+	Leaves ret;
+	for(auto& leaf : leaves) {
+		if(inside(leaf.first, projection)) {
+			ret.push_back(leaf);
+		}
+	}
+
+	return ret;
+}
+
+void collect(const Value& value, const std::string& path, Leaves& out) {
+	auto child = [&](std::string_view seg) {
+		return path.empty() ? std::string(seg) : path + "." + std::string(seg);
+	};
+
+	if(auto* str = std::get_if<std::string>(&value.value)) {
+		out.push_back({path, *str});
+	} else if(auto* vec = std::get_if<Vector>(&value.value)) {
+		for(auto i = 0u; i < vec->size(); ++i) {
+			collect(*(*vec)[i], child(std::to_string(i)), out);
+		}
+	} else if(auto* table = std::get_if<Table>(&value.value)) {
+		for(auto& [name, val] : *table) {
+			collect(*val, child(name), out);
+		}
+	}
+}
+
+std::optional<Leaves> parseDom(std::string_view input,
+		std::vector<std::string_view> projection) {
+	Parser parser{input};
+	parser.projection = std::move(projection);
+	auto res = parseTableOrArray(parser);
+	if(std::holds_alternative<Error>(res)) {
+		return std::nullopt;
+	}
+
+	Leaves leaves;
+	collect(std::get<NamedValue>(res).value, "", leaves);
+	std::sort(leaves.begin(), leaves.end());
+	return leaves;
+}
+
+void collectCb(struct parser* parser, const char* name, const char* value) {
+	std::string path = parser->nest_buf;
+	if(name) {
+		path += path.empty() ? "" : ".";
+		path += name;
+	}
+
+	static_cast<Leaves*>(parser->user)->push_back({path, value});
+}
+
+std::optional<Leaves> parseCb(const char* file,
+		const std::vector<std::string_view>& projection) {
+	std::vector<std::string> paths(projection.begin(), projection.end());
+	std::vector<const char*> cpaths;
+	for(auto& path : paths) {
+		cpaths.push_back(path.c_str());
+	}
+
+	Leaves leaves;
+	auto res = projection.empty() ?
+		parse_file(file, collectCb, &leaves) :
+		parse_file_projected(file, cpaths.data(), cpaths.size(), collectCb, &leaves);
+	if(res.error != error_type_none) {
+		return std::nullopt;
+	}
+
+	std::sort(leaves.begin(), leaves.end());
+	return leaves;
+}
+
+int main(int argc, const char** argv) {
+	auto file = argc > 1 ? argv[1] : "tests/atmosphere.qwe";
+	std::ifstream ifs(file);
+	std::stringstream ss;
+	ss << ifs.rdbuf();
+	auto input = ss.str();
+
+	auto full = parseDom(input, {});
+	auto fullCb = parseCb(file, {});
+	if(!full || !fullCb || full->empty()) {
+		std::printf("%s: full parse failed\n", file);
+		return EXIT_FAILURE;
+	}
+
+	const std::vector<std::vector<std::string_view>> projections = {
+		{"mie"},
+		{"rayleigh.scattering.rgb", "top"},
+		{"solar_irradiance.spectral", "mie.g"},
+		{"solar_irradiance", "bottom", "min_mu_s"},
+		{"nothing.here"},
+	};
+
+	auto ok = true;
+	for(auto& projection : projections) {
+		auto dom = parseDom(input, projection);
+		auto cb = parseCb(file, projection);
+		if(!dom || *dom != filter(*full, projection)) {
+			std::printf("parse.hpp: wrong values for '%s'\n", projection[0].data());
+			ok = false;
+		}
+
+		if(!cb || *cb != filter(*fullCb, projection)) {
+			std::printf("parse_cb.h: wrong values for '%s'\n", projection[0].data());
+			ok = false;
+		}
+	}
+
+	// skipped empty values are errors, like in a full parse
+	auto empty = "a:\n\tx: 1\nb:\n";
+	if(parseDom(empty, {}) || parseDom(empty, {"a"})) {
+		std::printf("parse.hpp: empty value accepted\n");
+		ok = false;
+	}
+
+	return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
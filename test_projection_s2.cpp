@@ -0,0 +1,106 @@
+// Checks that projected parses of s2/parse.hpp yield exactly the leaves
+// of a full parse that lie on or inside the projected paths. See
+// test_projection.cpp for parse.hpp and parse_cb.h, and
+// test_projected_s2.cpp for s2/projection.hpp.
+// Usage: test_projection_s2 [file], defaults to tests/atmosphere.qwe.
+#include "s2/parse.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <optional>
+#include <sstream>
+
+using Path = std::vector<std::string>;
+using Leaves = std::vector<Path>; // strings are tables without entries
+
+std::vector<std::string_view> segments(std::string_view path) {
+	std::vector<std::string_view> ret;
+	auto dot = path.find('.');
+	for(; dot != path.npos; dot = path.find('.')) {
+		ret.push_back(path.substr(0, dot));
+		path = path.substr(dot + 1);
+	}
+
+	ret.push_back(path);
+	return ret;
+}
+
+Leaves filter(const Leaves& leaves, const std::vector<std::string_view>& projection) {
+	Leaves ret;
+	for(auto& leaf : leaves) {
+		for(auto proj : projection) {
+			auto segs = segments(proj);
+			if(segs.size() <= leaf.size() &&
+					std::equal(segs.begin(), segs.end(), leaf.begin())) {
+				ret.push_back(leaf);
+				break;
+			}
+		}
+	}
+
+	return ret;
+}
+
+void collect(const Table& table, Path& path, Leaves& out) {
+	for(auto& [name, child] : table) {
+		path.push_back(name);
+		if(child.empty()) {
+			out.push_back(path);
+		} else {
+			collect(child, path, out);
+		}
+		path.pop_back();
+	}
+}
+
+std::optional<Leaves> parseLeaves(std::string_view input,
+		std::vector<std::string_view> projection) {
+	Parser parser{input};
+	parser.projection = std::move(projection);
+	Error error;
+	auto table = parseTable(parser, error);
+	if(error.type != ErrorType::none) {
+		return std::nullopt;
+	}
+
+	Leaves leaves;
+	Path path;
+	collect(table, path, leaves);
+	std::sort(leaves.begin(), leaves.end());
+	return leaves;
+}
+
+int main(int argc, const char** argv) {
+	auto file = argc > 1 ? argv[1] : "tests/atmosphere.qwe";
+	std::ifstream ifs(file);
+	std::stringstream ss;
+	ss << ifs.rdbuf();
+	auto input = ss.str();
+
+	auto full = parseLeaves(input, {});
+	if(!full || full->empty()) {
+		std::printf("%s: full parse failed\n", file);
+		return EXIT_FAILURE;
+	}
+
+	const std::vector<std::vector<std::string_view>> projections = {
+		{"mie"},
+		{"rayleigh.scattering.rgb", "top"},
+		{"solar_irradiance.spectral", "mie.g"},
+		{"solar_irradiance", "bottom", "min_mu_s"},
+		{"mie.nothing"},
+		{"nothing.here"},
+	};
+
+	auto ok = true;
+	for(auto& projection : projections) {
+		auto leaves = parseLeaves(input, projection);
+		if(!leaves || *leaves != filter(*full, projection)) {
+			std::printf("s2/parse.hpp: wrong values for '%s'\n", projection[0].data());
+			ok = false;
+		}
+	}
+
+	return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,73 @@
+// Stress test for rcu.hpp: reader threads take snapshots of a
+// document while it is republished, checking that every snapshot
+// is complete and versions only move forward.
+// Usage: test_rcu [publishes]
+#include "rcu.hpp"
+#include "data.hpp"
+#include "util.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+Value makeDocument(unsigned version) {
+	Table table;
+	table["version"] = std::make_unique<Value>(Value{std::to_string(version)});
+	Vector values;
+	for(auto i = 0u; i < 16u; ++i) {
+		values.push_back(std::make_unique<Value>(Value{std::to_string(version)}));
+	}
+	table["values"] = std::make_unique<Value>(Value{std::move(values)});
+	return {std::move(table)};
+}
+
+int main(int argc, const char** argv) {
+	auto publishes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 10000u;
+	ConfigHandle<Value> handle(makeDocument(0u));
+
+	std::atomic<bool> done {false};
+	std::atomic<unsigned> errors {0u};
+	auto read = [&]{
+		auto reader = handle.reader();
+		if(!reader) {
+			++errors;
+			return;
+		}
+
+		auto last = 0ul;
+		while(!done.load(std::memory_order_relaxed)) {
+			auto snap = reader->read();
+			auto version = std::stoul(asStringT(*at(*snap, "version")));
+			auto& values = asVectorT(*at(*snap, "values"));
+			for(auto& val : values) {
+				if(std::stoul(asStringT(*val)) != version) {
+					++errors;
+				}
+			}
+
+			if(version < last) {
+				++errors;
+			}
+
+			last = version;
+		}
+	};
+
+	std::vector<std::thread> readers;
+	for(auto i = 0u; i < 4u; ++i) {
+		readers.emplace_back(read);
+	}
+
+	for(auto v = 1u; v <= publishes; ++v) {
+		handle.publish(makeDocument(v));
+	}
+
+	done = true;
+	for(auto& reader : readers) {
+		reader.join();
+	}
+
+	auto pending = handle.reclaim();
+	std::printf("%lu publishes, %u errors, %zu versions pending\n",
+		publishes, errors.load(), pending);
+	return (errors == 0u && pending == 0u) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
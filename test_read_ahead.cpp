@@ -0,0 +1,44 @@
+// Checks that parse_file_read_ahead of parse_cb.h yields the same events
+// as parse_file and fails with error_type_read_failed for missing files.
+// Usage: test_read_ahead [file], defaults to tests/atmosphere.qwe.
+#include "parse_cb.h"
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <tuple>
+#include <vector>
+
+using Event = std::tuple<std::string, std::string, std::string, unsigned>;
+using Events = std::vector<Event>; // nest, name, value, line
+
+void collect(struct parser* parser, const char* name, const char* value) {
+	static_cast<Events*>(parser->user)->push_back({parser->nest_buf,
+		name ? name : "", value, parser->location.line});
+}
+
+int main(int argc, const char** argv) {
+	auto file = argc > 1 ? argv[1] : "tests/atmosphere.qwe";
+
+	Events plain;
+	auto res = parse_file(file, collect, &plain);
+	if(res.error != error_type_none || plain.empty()) {
+		std::printf("%s: parse failed\n", file);
+		return EXIT_FAILURE;
+	}
+
+	Events ahead;
+	res = parse_file_read_ahead(file, collect, &ahead);
+	if(res.error != error_type_none || ahead != plain) {
+		std::printf("read ahead: events differ\n");
+		return EXIT_FAILURE;
+	}
+
+	Events none;
+	res = parse_file_read_ahead("tests/does_not_exist.qwe", collect, &none);
+	if(res.error != error_type_read_failed || !none.empty()) {
+		std::printf("read ahead: missing file not reported\n");
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
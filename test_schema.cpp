@@ -0,0 +1,131 @@
+// Validates a document against a schema (see s2/schema.hpp) and
+// prints all violations. If the document has '# expect: <violation>'
+// comment lines, it must be invalid with exactly these violations, in
+// the printed format. Also checks that too deep schemas are rejected.
+// Usage: test_schema <schema> <file>
+#include "s2/schema.hpp"
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+std::string readFile(std::string_view filename) {
+	auto openmode = std::ios::ate;
+	std::ifstream ifs(std::string{filename}, openmode);
+	ifs.exceptions(std::ostream::failbit | std::ostream::badbit);
+
+	auto size = ifs.tellg();
+	ifs.seekg(0, std::ios::beg);
+
+	std::string buffer;
+	buffer.resize(size);
+	auto data = reinterpret_cast<char*>(buffer.data());
+	ifs.read(data, size);
+
+	return buffer;
+}
+
+const char* name(ViolationType type) {
+	switch(type) {
+		case ViolationType::missingField: return "missing field";
+		case ViolationType::unknownField: return "unknown field";
+		case ViolationType::wrongType: return "wrong type";
+		case ViolationType::outOfRange: return "out of range";
+		case ViolationType::tooFewItems: return "too few items";
+		case ViolationType::tooManyItems: return "too many items";
+	}
+
+	return "?";
+}
+
+// The '# expect: ' lines of the document.
+std::vector<std::string> expectations(std::string_view content) {
+	constexpr auto prefix = std::string_view("# expect: ");
+	std::vector<std::string> ret;
+	while(!content.empty()) {
+		auto nl = content.find('\n');
+		auto line = content.substr(0, nl);
+		if(line.substr(0, prefix.size()) == prefix) {
+			ret.emplace_back(line.substr(prefix.size()));
+		}
+
+		content.remove_prefix(nl == content.npos ? content.size() : nl + 1);
+	}
+
+	return ret;
+}
+
+// Schema tables nested deeper than the parser handles must fail the
+// compilation instead of being dropped.
+bool checkDeepSchema() {
+	std::string deep;
+	for(auto i = 0u; i < 70u; ++i) {
+		deep += std::string(i, '\t') + "fields:\n";
+	}
+
+	deep += std::string(70u, '\t') + "type: number\n";
+
+	std::string error;
+	if(compileSchema(deep, &error) || error.find("nested too deeply") != 0u) {
+		std::printf("deep schema not rejected: %s\n", error.c_str());
+		return false;
+	}
+
+	return true;
+}
+
+int main(int argc, const char** argv) {
+	if(argc < 3) {
+		std::printf("Usage: test_schema <schema> <file>\n");
+		return EXIT_FAILURE;
+	}
+
+	if(!checkDeepSchema()) {
+		return EXIT_FAILURE;
+	}
+
+	auto schemaSource = readFile(argv[1]);
+	std::string schemaError;
+	auto schema = compileSchema(schemaSource, &schemaError);
+	if(!schema) {
+		std::printf("Invalid schema: %s\n", schemaError.c_str());
+		return EXIT_FAILURE;
+	}
+
+	auto content = readFile(argv[2]);
+	Parser parser{content};
+	Error error;
+	std::vector<Violation> violations;
+	auto valid = validate(*schema, parser, error, violations);
+	if(error.type != ErrorType::none) {
+		std::printf("error %d at %d:%d\n", int(error.type),
+			error.location.line + 1, error.location.col + 1);
+	}
+
+	std::vector<std::string> reported;
+	for(auto& v : violations) {
+		char buf[256];
+		std::snprintf(buf, sizeof(buf), "%d:%d: %s: %.*s", v.location.line + 1,
+			v.location.col + 1, name(v.type), int(v.name.size()), v.name.data());
+		reported.emplace_back(buf);
+		std::printf("%s\n", buf);
+	}
+
+	std::printf("%s\n", valid ? "valid" : "invalid");
+
+	auto expected = expectations(content);
+	if(expected.empty()) {
+		return valid ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
+	if(valid || reported != expected) {
+		std::printf("expected:\n");
+		for(auto& line : expected) {
+			std::printf("%s\n", line.c_str());
+		}
+
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
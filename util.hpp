@@ -2,6 +2,15 @@
 
 #include "data.hpp"
 #include "parse.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bitset>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <memory>
 #include <stdexcept>
 
 std::string* asString(Value& value) {
@@ -24,6 +33,15 @@ const Vector* asVector(const Value& value) {
 	return std::get_if<Vector>(&value.value);
 }
 
+// Numeric arrays, see Parser::numericArrays. Contiguous, i.e. data()
+// and size() can be used like a span.
+const Integers* asIntegers(const Value& value) {
+	return std::get_if<Integers>(&value.value);
+}
+const Numbers* asNumbers(const Value& value) {
+	return std::get_if<Numbers>(&value.value);
+}
+
 const Value* at(const Value& value, std::string_view name) {
 	if(name.empty()) {
 		return &value;
@@ -50,6 +68,24 @@ const Value* at(const Value& value, std::string_view name) {
 	return at(*it->second, rest);
 }
 
+namespace detail {
+
+inline std::optional<long long> parseInteger(const std::string& str) {
+	char* end {};
+	auto cstr = str.c_str();
+	auto v = std::strtoll(cstr, &end, 10u);
+	return end == cstr ? std::nullopt : std::optional(v);
+}
+
+inline std::optional<long double> parseFloating(const std::string& str) {
+	char* end {};
+	auto cstr = str.c_str();
+	auto v = std::strtold(cstr, &end);
+	return end == cstr ? std::nullopt : std::optional(v);
+}
+
+} // namespace detail
+
 // Fallback
 template<typename T>
 struct ValueParser {
@@ -60,15 +96,11 @@ struct ValueParser {
 		}
 
 		if constexpr(std::is_integral_v<T>) {
-			char* end {};
-			auto cstr = str->c_str();
-			auto v = std::strtoll(cstr, &end, 10u);
-			return end == cstr ? std::nullopt : std::optional(T(v));
+			auto v = detail::parseInteger(*str);
+			return v ? std::optional(T(*v)) : std::nullopt;
 		} else if constexpr(std::is_floating_point_v<T>) {
-			char* end {};
-			auto cstr = str->c_str();
-			auto v = std::strtold(cstr, &end);
-			return end == cstr ? std::nullopt : std::optional(T(v));
+			auto v = detail::parseFloating(*str);
+			return v ? std::optional(T(*v)) : std::nullopt;
 		} else {
 			static_assert(templatize<T>(false), "Can't parse type");
 		}
@@ -107,9 +139,54 @@ std::optional<std::vector<T>> asVector(const Vector& vector) {
 	return ret;
 }
 
+namespace detail {
+
+// Converts an item of a numeric array. Arithmetic types and strings
+// are supported, nullopt for all others.
+template<typename T, typename N>
+std::optional<T> convertNumber(N number) {
+	if constexpr(std::is_arithmetic_v<T>) {
+		return T(number);
+	} else if constexpr(std::is_same_v<T, std::string>) {
+		if constexpr(std::is_integral_v<N>) {
+			return std::to_string(number);
+		} else {
+			return numberString(number);
+		}
+	} else {
+		return std::nullopt;
+	}
+}
+
+} // namespace detail
+
+// Converts the items of numeric arrays.
+template<typename T, typename C>
+std::optional<std::vector<T>> asVector(const C& numbers) {
+	if constexpr(std::is_arithmetic_v<T>) {
+		return std::vector<T>(numbers.begin(), numbers.end());
+	} else if constexpr(std::is_same_v<T, std::string>) {
+		std::vector<T> ret;
+		ret.reserve(numbers.size());
+		for(auto number : numbers) {
+			ret.push_back(*detail::convertNumber<T>(number));
+		}
+
+		return ret;
+	} else {
+		return std::nullopt;
+	}
+}
+
 template<typename T>
 struct ValueParser<std::vector<T>> {
 	static std::optional<std::vector<T>> call(const Value& value) {
+		if(auto* ints = asIntegers(value)) {
+			return asVector<T>(*ints);
+		} else if(auto* nums = asNumbers(value)) {
+			return asVector<T>(*nums);
+		}
+
 		auto* vec = asVector(value);
 		return vec ? asVector<T>(*vec) : std::nullopt;
 	}
@@ -120,10 +197,357 @@ std::optional<T> as(const Value& value) {
 	return ValueParser<T>::call(value);
 }
 
+// Memoized numeric conversions of string values, an opt-in side table
+// like FingerprintCache: as<T>(value, cache) converts the string of a
+// value once and later returns the stored result. The table has a fixed
+// number of slots, chosen by the address of the value; a value evicts
+// the one in its slot, so memory is bounded and colliding values are
+// just converted again. Slots keep the text they were computed from,
+// replaced or modified strings (and new values at the address of
+// destroyed ones) don't match and are converted again.
+// A hit is not free: it hashes the address, reads the slot without
+// locking (a concurrent writer turns it into a miss) and compares the
+// text. That's several times cheaper than strtold, but for integers
+// about as expensive as strtoll. Strings longer than maxText and long
+// double aren't cached. Safe for concurrent use.
+class NumberCache {
+public:
+	static constexpr std::size_t maxText = 22u;
+
+	// The number of slots is rounded up to a power of two.
+	explicit NumberCache(std::size_t slots = 4096u) {
+		capacity_ = 1u;
+		while(capacity_ < slots) {
+			capacity_ *= 2u;
+		}
+
+		slots_ = std::make_unique<Slot[]>(capacity_);
+	}
+
+	// Like as<T>(value) for numeric T, memoized.
+	template<typename T>
+	std::optional<T> get(const Value& value) {
+		static_assert(std::is_arithmetic_v<T>, "Only numbers are cached");
+		constexpr auto integral = std::is_integral_v<T>;
+		auto* str = asString(value);
+		if(!str || std::is_same_v<T, long double> || str->size() > maxText) {
+			return ValueParser<T>::call(value);
+		}
+
+		constexpr auto setFlag = integral ? integerSet : floatingSet;
+		constexpr auto failedFlag = integral ? integerFailed : floatingFailed;
+		auto& slot = slots_[index(&value)];
+		auto text = pack(*str);
+
+		// seqlock read: only valid if no writer was active meanwhile
+		auto version = slot.version.load(std::memory_order_acquire);
+		if(!(version & 1u)) {
+			auto matches = slot.value.load(std::memory_order_relaxed) == &value &&
+				slot.size.load(std::memory_order_relaxed) == str->size();
+			for(auto i = 0u; i < text.size(); ++i) {
+				matches &= (slot.text[i].load(std::memory_order_relaxed) == text[i]);
+			}
+
+			auto flags = slot.flags.load(std::memory_order_relaxed);
+			T res {};
+			if constexpr(integral) {
+				res = T(slot.integer.load(std::memory_order_relaxed));
+			} else if constexpr(std::is_same_v<T, float>) {
+				res = slot.single.load(std::memory_order_relaxed);
+			} else {
+				res = T(slot.floating.load(std::memory_order_relaxed));
+			}
+
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if(matches && slot.version.load(std::memory_order_relaxed) == version) {
+				if(flags & setFlag) {
+					return res;
+				} else if(flags & failedFlag) {
+					return std::nullopt;
+				}
+			}
+		}
+
+		std::optional<long long> integer;
+		std::optional<long double> floating;
+		if constexpr(integral) {
+			integer = detail::parseInteger(*str);
+		} else {
+			floating = detail::parseFloating(*str);
+		}
+
+		// store unless another writer has the slot, that one wins
+		version = slot.version.load(std::memory_order_relaxed);
+		if(!(version & 1u) && slot.version.compare_exchange_strong(version,
+				version + 1u, std::memory_order_acquire)) {
+			std::atomic_thread_fence(std::memory_order_release);
+			auto same = slot.value.load(std::memory_order_relaxed) == &value &&
+				slot.size.load(std::memory_order_relaxed) == str->size();
+			for(auto i = 0u; i < text.size(); ++i) {
+				same &= (slot.text[i].load(std::memory_order_relaxed) == text[i]);
+			}
+
+			std::uint8_t flags = same ? slot.flags.load(std::memory_order_relaxed) : 0u;
+			if(!same) {
+				slot.value.store(&value, std::memory_order_relaxed);
+				slot.size.store(std::uint8_t(str->size()), std::memory_order_relaxed);
+				for(auto i = 0u; i < text.size(); ++i) {
+					slot.text[i].store(text[i], std::memory_order_relaxed);
+				}
+			}
+
+			if(integer) {
+				slot.integer.store(*integer, std::memory_order_relaxed);
+			} else if(floating) {
+				slot.floating.store(double(*floating), std::memory_order_relaxed);
+				slot.single.store(float(*floating), std::memory_order_relaxed);
+			}
+
+			flags |= (integer || floating) ? setFlag : failedFlag;
+			slot.flags.store(flags, std::memory_order_relaxed);
+			slot.version.store(version + 2u, std::memory_order_release);
+		}
+
+		if constexpr(integral) {
+			return integer ? std::optional(T(*integer)) : std::nullopt;
+		} else {
+			return floating ? std::optional(T(*floating)) : std::nullopt;
+		}
+	}
+
+	std::size_t capacity() const {
+		return capacity_;
+	}
+
+	// Number of cached values, at most capacity(). Walks all slots.
+	std::size_t size() const {
+		std::size_t ret = 0u;
+		for(auto i = 0u; i < capacity_; ++i) {
+			ret += (slots_[i].value.load(std::memory_order_relaxed) != nullptr);
+		}
+
+		return ret;
+	}
+
+	void clear() {
+		for(auto i = 0u; i < capacity_; ++i) {
+			auto& slot = slots_[i];
+			auto version = slot.version.load(std::memory_order_relaxed);
+			while((version & 1u) || !slot.version.compare_exchange_weak(version,
+					version + 1u, std::memory_order_acquire)) {
+				version = slot.version.load(std::memory_order_relaxed);
+			}
+
+			std::atomic_thread_fence(std::memory_order_release);
+			slot.value.store(nullptr, std::memory_order_relaxed);
+			slot.flags.store(0u, std::memory_order_relaxed);
+			slot.version.store(version + 2u, std::memory_order_release);
+		}
+	}
+
+private:
+	enum Flags : std::uint8_t {
+		integerSet = 1u,
+		integerFailed = 2u, // not an integer
+		floatingSet = 4u, // float and double
+		floatingFailed = 8u, // not a number
+	};
+
+	// The chars of a string up to maxText, see pack.
+	using Text = std::array<std::uint64_t, 3>;
+	static_assert(maxText <= sizeof(Text));
+
+	// All members atomic so that the optimistic reads don't race.
+	// The version is odd while a writer changes the slot.
+	struct alignas(64) Slot {
+		std::atomic<std::uint32_t> version {};
+		std::atomic<std::uint8_t> flags {};
+		std::atomic<std::uint8_t> size {};
+		std::atomic<const Value*> value {};
+		std::atomic<std::uint64_t> text[3] {};
+		std::atomic<long long> integer {};
+		std::atomic<double> floating {};
+		std::atomic<float> single {};
+	};
+
+	// Packs the text into words, with a few (overlapping) loads instead
+	// of a byte copy. Only unique together with the size.
+	static Text pack(const std::string& str) {
+		auto load = [&](std::size_t off, auto word) {
+			std::memcpy(&word, str.data() + off, sizeof(word));
+			return std::uint64_t(word);
+		};
+
+		Text ret {};
+		auto n = str.size();
+		auto i = std::size_t(0u);
+		for(; n - i >= 8u; i += 8u) {
+			ret[i / 8u] = load(i, std::uint64_t{});
+		}
+
+		auto rest = n - i;
+		if(rest >= 4u) {
+			ret[i / 8u] = load(i, std::uint32_t{}) |
+				(load(n - 4u, std::uint32_t{}) << 32u);
+		} else if(rest > 0u) {
+			ret[i / 8u] = load(i, std::uint8_t{}) |
+				(load(i + rest / 2u, std::uint8_t{}) << 8u) |
+				(load(n - 1u, std::uint8_t{}) << 16u);
+		}
+
+		return ret;
+	}
+
+	std::size_t index(const Value* value) const {
+		auto hash = std::uint64_t(reinterpret_cast<std::uintptr_t>(value)) *
+			0x9E3779B97F4A7C15ull;
+		return std::size_t(hash >> 32u) & (capacity_ - 1u);
+	}
+
+	std::size_t capacity_ {};
+	std::unique_ptr<Slot[]> slots_;
+};
+
+template<typename T>
+std::optional<T> as(const Value& value, NumberCache& cache) {
+	return cache.get<T>(value);
+}
+
+// Lazy, typed view of a vector or numeric array: items are converted
+// via ValueParser<T> (or like asVector<T> for numeric arrays) when
+// dereferenced, yielding nullopt if they can't be. Unlike asVector<T>
+// nothing is allocated or converted up front, so reading a few items
+// or stopping early is cheap. Only valid as long as the array isn't
+// modified.
+// if(auto range = asRange<float>(value)) {
+// 	for(auto item : *range) { ... }
+// }
+template<typename T>
+class ValueRange {
+private:
+	// The viewed array, exactly one of the pointers is set. Copied
+	// into the iterators, they stay valid when the range is gone.
+	struct Source {
+		const Vector* vector {};
+		const Integers* integers {};
+		const Numbers* numbers {};
+
+		std::optional<T> get(std::size_t i) const {
+			if(integers) {
+				return detail::convertNumber<T>((*integers)[i]);
+			} else if(numbers) {
+				return detail::convertNumber<T>((*numbers)[i]);
+			}
+
+			return ValueParser<T>::call(*(*vector)[i]);
+		}
+	};
+
+public:
+	class Iterator {
+	public:
+		using iterator_category = std::random_access_iterator_tag;
+		using value_type = std::optional<T>;
+		using difference_type = std::ptrdiff_t;
+		using pointer = void;
+		using reference = std::optional<T>; // converted on dereference
+
+		Iterator() = default;
+		Iterator(Source source, difference_type i) : source_(source), i_(i) {}
+
+		std::optional<T> operator*() const { return source_.get(i_); }
+		std::optional<T> operator[](difference_type i) const { return *(*this + i); }
+
+		Iterator& operator++() { ++i_; return *this; }
+		Iterator& operator--() { --i_; return *this; }
+		Iterator operator++(int) { return Iterator(source_, i_++); }
+		Iterator operator--(int) { return Iterator(source_, i_--); }
+		Iterator& operator+=(difference_type n) { i_ += n; return *this; }
+		Iterator& operator-=(difference_type n) { i_ -= n; return *this; }
+
+		friend Iterator operator+(Iterator a, difference_type n) { return a += n; }
+		friend Iterator operator+(difference_type n, Iterator a) { return a += n; }
+		friend Iterator operator-(Iterator a, difference_type n) { return a -= n; }
+		friend difference_type operator-(const Iterator& a, const Iterator& b) { return a.i_ - b.i_; }
+
+		friend bool operator==(const Iterator& a, const Iterator& b) { return a.i_ == b.i_; }
+		friend bool operator!=(const Iterator& a, const Iterator& b) { return a.i_ != b.i_; }
+		friend bool operator<(const Iterator& a, const Iterator& b) { return a.i_ < b.i_; }
+		friend bool operator>(const Iterator& a, const Iterator& b) { return a.i_ > b.i_; }
+		friend bool operator<=(const Iterator& a, const Iterator& b) { return a.i_ <= b.i_; }
+		friend bool operator>=(const Iterator& a, const Iterator& b) { return a.i_ >= b.i_; }
+
+	private:
+		Source source_ {};
+		difference_type i_ {};
+	};
+
+	explicit ValueRange(const Vector& vector) : source_{&vector, nullptr, nullptr}, size_(vector.size()) {}
+	explicit ValueRange(const Integers& integers) : source_{nullptr, &integers, nullptr}, size_(integers.size()) {}
+	explicit ValueRange(const Numbers& numbers) : source_{nullptr, nullptr, &numbers}, size_(numbers.size()) {}
+
+	Iterator begin() const { return Iterator(source_, 0); }
+	Iterator end() const { return Iterator(source_, std::ptrdiff_t(size_)); }
+	std::size_t size() const { return size_; }
+	bool empty() const { return size_ == 0u; }
+
+	// Asserts that i is in range.
+	std::optional<T> operator[](std::size_t i) const {
+		assert(i < size());
+		return source_.get(i);
+	}
+
+	// Converts the items [offset, offset + count) into out, without
+	// allocating. Returns false if an item couldn't be converted, out
+	// is then only partially written. The range must be valid.
+	bool convert(T* out, std::size_t count, std::size_t offset = 0u) const {
+		assert(offset + count <= size());
+		if constexpr(std::is_arithmetic_v<T>) {
+			if(source_.integers) {
+				auto first = source_.integers->begin() + offset;
+				std::copy(first, first + count, out);
+				return true;
+			} else if(source_.numbers) {
+				auto first = source_.numbers->begin() + offset;
+				std::copy(first, first + count, out);
+				return true;
+			}
+		}
+
+		for(auto i = 0u; i < count; ++i) {
+			auto v = source_.get(offset + i);
+			if(!v) {
+				return false;
+			}
+
+			out[i] = std::move(*v);
+		}
+
+		return true;
+	}
+
+private:
+	Source source_;
+	std::size_t size_;
+};
+
+// Returns nullopt if value isn't a vector or numeric array.
+template<typename T>
+std::optional<ValueRange<T>> asRange(const Value& value) {
+	if(auto* ints = asIntegers(value)) {
+		return ValueRange<T>(*ints);
+	} else if(auto* nums = asNumbers(value)) {
+		return ValueRange<T>(*nums);
+	}
+
+	auto* vec = asVector(value);
+	return vec ? std::optional(ValueRange<T>(*vec)) : std::nullopt;
+}
+
 template<typename T>
 std::optional<T> as(const Value& value, std::string_view field) {
 	auto v = at(value, field);
-	return v ? as<T>(v) : std::nullopt;
+	return v ? as<T>(*v) : std::nullopt;
 }
 
 template<typename T>
@@ -149,37 +573,151 @@ std::optional<T> asT(const Value& value, std::string_view field) {
 template<typename T>
 Value print(const T& val);
 
-template<typename T, typename D = ValueParser<T>>
-struct PodParser {
-	static std::optional<T> parse(const Value& value) {
-		T res;
-		auto map = D::map(res);
+namespace detail {
 
-		bool error = for_each_or(map, [&](auto& entry) {
-			auto& v = entry.val;
-			using V = std::decay_t<decltype(v)>;
+// Tree of the dotted names of a PodParser map, one node per segment.
+struct PodKeyNode {
+	std::string_view name;
+	int field {-1}; // index into the map, -1 if it's only a prefix
+	std::vector<PodKeyNode> children; // sorted by name
+};
 
-			auto val = at(value, entry.name);
-			if(!val) {
-				return entry.required;
-			}
+inline const PodKeyNode* findPodKey(const PodKeyNode& node, std::string_view name) {
+	auto it = std::lower_bound(node.children.begin(), node.children.end(), name,
+		[](const PodKeyNode& n, std::string_view name) { return n.name < name; });
+	return (it == node.children.end() || it->name != name) ? nullptr : &*it;
+}
 
-			auto pv = as<V>(*val);
-			if(!pv) {
-				return true;
+inline PodKeyNode& podKeyChild(PodKeyNode& node, std::string_view name) {
+	auto it = std::lower_bound(node.children.begin(), node.children.end(), name,
+		[](const PodKeyNode& n, std::string_view name) { return n.name < name; });
+	if(it == node.children.end() || it->name != name) {
+		it = node.children.insert(it, PodKeyNode{name, -1, {}});
+	}
+
+	return *it;
+}
+
+// Binds the entries of the MapEntry tuple Map of T, see PodParser.
+template<typename T, typename Map>
+struct PodBinder {
+	static constexpr auto count = std::tuple_size_v<Map>;
+	using Mask = std::bitset<count>;
+
+	struct Keys {
+		PodKeyNode root;
+		Mask required;
+	};
+
+	static bool bind(const Value& value, Map& map) {
+		auto& k = keys(map);
+		Mask found;
+		return walk(value, k.root, map, found) && (k.required & ~found).none();
+	}
+
+	static const Keys& keys(Map& map) {
+		static const Keys keys = [&]{
+			Keys ret;
+			auto i = 0;
+			std::apply([&](auto&... entries) {
+				(addKey(ret, entries.name, entries.required, i++), ...);
+			}, map);
+			return ret;
+		}();
+
+		return keys;
+	}
+
+	static void addKey(Keys& keys, std::string_view name, bool required, int i) {
+		auto* node = &keys.root;
+		while(true) {
+			auto dot = name.find('.');
+			node = &podKeyChild(*node, name.substr(0, dot));
+			if(dot == name.npos) {
+				break;
 			}
 
-			v = *pv;
+			name = name.substr(dot + 1);
+		}
+
+		node->field = i;
+		keys.required.set(i, required);
+	}
+
+	template<std::size_t I>
+	static bool parseEntry(Map& map, const Value& value) {
+		auto& entry = std::get<I>(map);
+		using V = std::decay_t<decltype(entry.val)>;
+		auto pv = as<V>(value);
+		if(!pv) {
 			return false;
-		});
+		}
+
+		entry.val = std::move(*pv);
+		return true;
+	}
+
+	template<std::size_t... I>
+	static constexpr auto makeParsers(std::index_sequence<I...>) {
+		using Func = bool(*)(Map&, const Value&);
+		return std::array<Func, count>{&parseEntry<I>...};
+	}
+
+	static constexpr auto parsers = makeParsers(std::make_index_sequence<count>());
+
+	static bool walk(const Value& value, const PodKeyNode& node, Map& map, Mask& found) {
+		auto* table = asTable(value);
+		if(!table) {
+			return true; // entries are missing, see 'required'
+		}
+
+		for(auto& [key, child] : *table) {
+			auto* kn = findPodKey(node, key);
+			if(!kn) {
+				continue;
+			}
+
+			if(kn->field >= 0) {
+				if(!parsers[kn->field](map, *child)) {
+					return false;
+				}
+
+				found.set(kn->field);
+			}
+
+			if(!kn->children.empty() && !walk(*child, *kn, map, found)) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+};
+
+} // namespace detail
 
-		if(error) {
+// Binds a table to the struct T via the MapEntry tuple returned by D::map.
+// Walks each table of the value once: every key is looked up in a tree
+// of the (dotted) entry names, built once per T, and dispatched to its
+// entry via a table of parse functions. Only tables that contain
+// entries are descended into. The entry names must outlive the
+// program, e.g. string literals.
+template<typename T, typename D = ValueParser<T>>
+struct PodParser {
+	static std::optional<T> parse(const Value& value) {
+		T res {};
+		auto map = D::map(res);
+		if(!detail::PodBinder<T, decltype(map)>::bind(value, map)) {
 			return std::nullopt;
 		}
 
 		return res;
 	}
 
+	static std::optional<T> call(const Value& value) {
+		return parse(value);
+	}
+
 	static Value print(const T& val) {
 		auto map = D::map(val);
 		Table table;